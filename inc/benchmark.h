@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include <map>
+#include <stdio.h>
+
+using namespace std;
+
+/**
+ * Timer - Nanosecond wall clock timer on steady_clock, for timing a single piece of
+ * code inline.
+ *
+ * Usage:
+ *
+ *     Timer timer;
+ *     timer.Start();
+ *     ...
+ *     printf("%gms\n", timer.ElapsedMs());
+ */
+
+struct Timer
+{
+    uint64_t startNs;
+
+    Timer() : startNs(0) {};
+
+    void Start();
+    uint64_t ElapsedNs() const;
+    double ElapsedMs() const { return (double)ElapsedNs() / 1e6; }
+};
+
+/**
+ * PerfCounters - Hardware cycle and last level cache miss counters for the calling
+ * thread, through perf_event_open. Only available on Linux, and only if the kernel lets
+ * this process count its own events (see /proc/sys/kernel/perf_event_paranoid).
+ * Elsewhere Open just returns false.
+ */
+
+struct PerfCounters
+{
+    int cyclesFd;
+    int missesFd;
+
+    PerfCounters() : cyclesFd(-1), missesFd(-1) {};
+    ~PerfCounters() { Close(); }
+
+    bool Open();
+    void Close();
+    void Start();
+    void Stop(uint64_t &cycles, uint64_t &cacheMisses);
+};
+
+/**
+ * BenchOptions - How to run a benchmark: untimed warm-up runs first (to fault in memory,
+ * fill caches and let lazy tables build), then timed trials. counters turns on
+ * PerfCounters where they're available.
+ */
+
+struct BenchOptions
+{
+    uint32_t warmup;
+    uint32_t trials;
+    bool counters;
+
+    BenchOptions() : warmup(1), trials(5), counters(false) {};
+};
+
+/**
+ * BenchStats - Results of runBenchmark. Wall times are per trial. The timestamp counter
+ * median is there for kernels short enough that a nanosecond clock is coarse. Cycle and
+ * cache miss counts, when hasCounters is set, are per trial averages.
+ */
+
+struct BenchStats
+{
+    string name;
+    uint32_t trials;
+
+    double minMs;
+    double medianMs;
+    double p95Ms;
+    double meanMs;
+    uint64_t medianTsc;
+
+    bool hasCounters;
+    uint64_t cycles;
+    uint64_t cacheMisses;
+
+    vector<double> trialMs;
+};
+
+/**
+ * OutputCapture - Redirect everything written to stdout, by printf or cout, into a
+ * temporary file until End, and hand back what was written. Works at the file
+ * descriptor level, so it catches output from anything in the process.
+ *
+ * Usage:
+ *
+ *     OutputCapture capture;
+ *     capture.Begin();
+ *     ...
+ *     string output = capture.End();
+ */
+
+struct OutputCapture
+{
+    int savedFd;
+    FILE* pFile;
+
+    OutputCapture() : savedFd(-1), pFile(nullptr) {};
+    ~OutputCapture() { End(); }
+
+    bool Begin();
+    string End();
+};
+
+/**
+ * BenchResult - One problem's results in a benchmark suite run. status is "pass" or
+ * "fail" against the expected answer, or "unknown" if there isn't one.
+ */
+
+struct BenchResult
+{
+    BenchStats stats;
+    uint64_t peakRssKb;
+    string answer;
+    string expected;
+    string status;
+};
+
+uint64_t GetNanoseconds();
+BenchStats runBenchmark(const string &name, function<void()> fn, const BenchOptions &options = BenchOptions());
+void printBenchStats(const BenchStats &stats);
+uint64_t getPeakRssKb();
+bool globMatch(const char* pPattern, const char* pStr);
+string lastLine(const string &text);
+bool readExpectedAnswers(const char* fileName, map<string, string> &answers);
+bool writeExpectedAnswers(const char* fileName, const map<string, string> &answers);
+bool writeBenchJson(const char* fileName, const vector<BenchResult> &results);
+bool writeBenchCsv(const char* fileName, const vector<BenchResult> &results);
+uint64_t getPhysicalMemoryMb();
+string getExecutablePath(const char* argv0);
+int runCommand(const string &command, string &output);
+double fitPowerLaw(const vector<double> &sizes, const vector<double> &times, double &coef, double &rSquared);
\ No newline at end of file
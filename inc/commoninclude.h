@@ -15,10 +15,15 @@
 #include <functional>
 #include <complex>
 #include <cmath>
+#include <memory>
 
 #include "primes.h"
+#include "primefile.h"
 #include "utils.h"
+#include "modarith.h"
+#include "benchmark.h"
 #include "CTFFTR2.h"
+#include "ntt.h"
 #include "quicksort.h"
 #include "rsa.h"
 #include "huffman.h"
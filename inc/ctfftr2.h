@@ -1,9 +1,12 @@
 #pragma once
 
+#include <stdint.h>
 #include <vector>
+#include <map>
 #include <assert.h>
 #include <math.h>
 #include <complex>
+#include <memory>
 #include "utils.h"
 
 using namespace std;
@@ -15,8 +18,132 @@ struct SinusoidsParams
     double shift;
 };
 
+/**
+ * FFTKernel - Butterfly scheme for a transform. All of them produce the same DFT.
+ *
+ * FFT_RADIX2       - One stage per bit, two points per butterfly. The simple reference.
+ * FFT_RADIX4       - Two stages per pass, with 3 complex multiplies per 4 points instead
+ *                    of 4, and half the passes over memory.
+ * FFT_SPLIT_RADIX  - Recursive split-radix (N/2 + 2 * N/4), the fewest multiplies of the
+ *                    three, working depth first so subtransforms stay in cache. Small
+ *                    subtransforms finish with radix-4 passes.
+ *
+ * Kernels only apply to power-of-two transforms. Other sizes pass theirs on to the
+ * power-of-two transforms Bluestein's algorithm runs, if they use it.
+ */
+
+enum FFTKernel
+{
+    FFT_RADIX2,
+    FFT_RADIX4,
+    FFT_SPLIT_RADIX
+};
+
+/**
+ * FFTPlan - Precomputed tables for forward FFTs of one size. Init builds every table
+ * once, and Execute then runs the transform in place, so repeated transforms of the
+ * same size cost only the arithmetic. The size picks the algorithm:
+ *
+ * Powers of two - Bit reversal permutation, then iterative butterflies with any kernel.
+ * Twiddles are laid out by stage, with real and imaginary parts in separate arrays: the
+ * stage combining blocks of n points reads twRe/twIm[n / 2 + k] = w_n^k for k < n / 2,
+ * where w_n = e^(-2 pi i / n), so every stage walks its factors contiguously.
+ * tw3Re/tw3Im[n / 4 + k] = w_n^3k, for k < n / 4, serve the radix-4 and split-radix
+ * kernels.
+ *
+ * Products of 2, 3, 5 and 7 - Mixed radix Stockham passes, one per entry of factors,
+ * radix 4 where possible. Each pass reads one array and writes another in natural
+ * order, so there's no permutation, with a per-thread scratch array as the other
+ * buffer. The pass that takes subtransforms of length L to length pL reads twRe/twIm
+ * [offset + (s - 1) L + k] = w_pL^sk, s < p, k < L, each pass's block after the last.
+ *
+ * Anything else - Bluestein's chirp-z algorithm. With nk = (n^2 + k^2 - (k - n)^2) / 2,
+ * the DFT is a convolution with the chirp w_2N^(n^2), done with power-of-two FFTs of at
+ * least 2N - 1 points by convPlan. chirpRe/chirpIm hold the chirp and convRe/convIm the
+ * transform of the sequence it's convolved with. Two power-of-two transforms of 2N to 4N
+ * points each time, so slower than a smooth size but still O(N log N).
+ *
+ * Execute works on interleaved complex values, with radix-2 butterflies for powers of
+ * two. The split array (SoA) overload takes any kernel, and runs them with AVX2 and FMA
+ * when the CPU has them. Execute allocates only scratch, per thread, the first time a
+ * thread needs more of it.
+ *
+ * Usage:
+ *
+ *     FFTPlan plan;
+ *     plan.Init(1000);
+ *
+ *     plan.Execute(samples.data());
+ *     plan.Execute(re.data(), im.data(), FFT_SPLIT_RADIX);
+ */
+
+struct FFTPlan
+{
+    uint32_t size;
+    vector<uint32_t> bitReverse;
+    vector<double> twRe;
+    vector<double> twIm;
+    vector<double> tw3Re;
+    vector<double> tw3Im;
+    vector<uint32_t> factors;
+    shared_ptr<FFTPlan> convPlan;
+    vector<double> chirpRe;
+    vector<double> chirpIm;
+    vector<double> convRe;
+    vector<double> convIm;
+
+    FFTPlan() : size(0) {};
+
+    void Init(uint32_t sizeIn);
+    void Execute(complex<double>* pData) const;
+    void Execute(double* pRe, double* pIm, FFTKernel kernel) const;
+    void ExecuteInverse(double* pRe, double* pIm, FFTKernel kernel) const;
+};
+
+/**
+ * RealFFTPlan - FFTs of real signals of one even size N, at about half the cost
+ * of a complex FFT. The N samples are packed into N / 2 complex values, even samples as
+ * real parts and odd as imaginary, which go through an N / 2 point complex FFT. One
+ * extra pass then untangles the transforms of the even and odd samples and merges them
+ * into the N / 2 + 1 bins that describe the whole spectrum (the rest are the complex
+ * conjugates of these).
+ *
+ * Execute reads the samples and writes the N / 2 + 1 bins to split real and imaginary
+ * arrays. ExecuteInverse goes back, scaled so a round trip returns the input, and uses
+ * the spectrum arrays as scratch. Neither allocates, beyond any scratch the half size
+ * transform needs.
+ *
+ * Usage:
+ *
+ *     RealFFTPlan plan;
+ *     plan.Init(1024);
+ *
+ *     vector<double> re(513), im(513);
+ *     plan.Execute(samples.data(), re.data(), im.data());
+ */
+
+struct RealFFTPlan
+{
+    uint32_t size;
+    FFTPlan halfPlan;
+    vector<double> twRe;
+    vector<double> twIm;
+
+    RealFFTPlan() : size(0) {};
+
+    void Init(uint32_t sizeIn);
+    void Execute(const double* pSamples, double* pRe, double* pIm, FFTKernel kernel = FFT_SPLIT_RADIX) const;
+    void ExecuteInverse(double* pRe, double* pIm, double* pSamples, FFTKernel kernel = FFT_SPLIT_RADIX) const;
+};
+
 void GetWaveform(vector<SinusoidsParams> &waves, vector<double> &domain, vector<complex<double>> &samples);
+void GetRealWaveform(vector<SinusoidsParams> &waves, vector<double> &domain, vector<double> &samples);
 void DFTDirect(vector<complex<double>> &samples, vector<complex<double>> &dft);
-void FFT(vector<complex<double>> &waveform, vector<complex<double>> &fft);
+const FFTPlan& GetFFTPlan(uint32_t size);
+void FFT(vector<complex<double>> &waveform, vector<complex<double>> &fft, FFTKernel kernel = FFT_SPLIT_RADIX);
+void InverseFFT(vector<complex<double>> &fft, vector<complex<double>> &waveform, FFTKernel kernel = FFT_SPLIT_RADIX);
+const RealFFTPlan& GetRealFFTPlan(uint32_t size);
+void RealFFT(const vector<double> &samples, vector<complex<double>> &spectrum, FFTKernel kernel = FFT_SPLIT_RADIX);
+void InverseRealFFT(const vector<complex<double>> &spectrum, vector<double> &samples, FFTKernel kernel = FFT_SPLIT_RADIX);
 
 void TestDFT();
\ No newline at end of file
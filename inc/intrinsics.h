@@ -0,0 +1,256 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// __debugbreak is MSVC only. Elsewhere, stop in the debugger the same way.
+
+#if !defined(_MSC_VER) && !defined(__debugbreak)
+#include <signal.h>
+#define __debugbreak() raise(SIGTRAP)
+#endif
+
+/**
+ * ctz64 - Count trailing zero bits of a 64-bit value. Undefined for zero.
+ *
+ * @param val Value to count trailing zeros of.
+ *
+ * @return Index of the lowest set bit.
+ */
+
+static inline uint32_t ctz64(uint64_t val)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, val);
+    return (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_ctzll(val);
+#endif
+}
+
+/**
+ * clz64 - Count leading zero bits of a 64-bit value. Undefined for zero.
+ *
+ * @param val Value to count leading zeros of.
+ *
+ * @return 63 minus the index of the highest set bit.
+ */
+
+static inline uint32_t clz64(uint64_t val)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, val);
+    return 63 - (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_clzll(val);
+#endif
+}
+
+/**
+ * popcount64 - Count set bits in a 64-bit value.
+ *
+ * @param val Value to count bits of.
+ *
+ * @return Number of set bits.
+ */
+
+static inline uint32_t popcount64(uint64_t val)
+{
+#ifdef _MSC_VER
+    return (uint32_t)__popcnt64(val);
+#else
+    return (uint32_t)__builtin_popcountll(val);
+#endif
+}
+
+/**
+ * mul128 - Full 64 x 64 -> 128-bit unsigned multiply.
+ *
+ * @param a  First value.
+ * @param b  Second value.
+ * @param hi (out) High 64 bits of the product.
+ *
+ * @return Low 64 bits of the product.
+ */
+
+static inline uint64_t mul128(uint64_t a, uint64_t b, uint64_t &hi)
+{
+#ifdef _MSC_VER
+    return _umul128(a, b, &hi);
+#else
+    unsigned __int128 prod = (unsigned __int128)a * b;
+    hi = (uint64_t)(prod >> 64);
+    return (uint64_t)prod;
+#endif
+}
+
+/**
+ * mulHi64 - High 64 bits of a 64 x 64-bit unsigned multiply.
+ *
+ * @param a First value.
+ * @param b Second value.
+ *
+ * @return High 64 bits of a * b.
+ */
+
+static inline uint64_t mulHi64(uint64_t a, uint64_t b)
+{
+#ifdef _MSC_VER
+    return __umulh(a, b);
+#else
+    return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#endif
+}
+
+/**
+ * div128 - Divide a 128-bit value by a 64-bit value. The quotient must fit in 64 bits,
+ * i.e., hi < d.
+ *
+ * @param hi  High 64 bits of the dividend.
+ * @param lo  Low 64 bits of the dividend.
+ * @param d   Divisor.
+ * @param rem (out) Remainder.
+ *
+ * @return Quotient.
+ */
+
+static inline uint64_t div128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t &rem)
+{
+#ifdef _MSC_VER
+    return _udiv128(hi, lo, d, &rem);
+#else
+    unsigned __int128 num = ((unsigned __int128)hi << 64) | lo;
+    rem = (uint64_t)(num % d);
+    return (uint64_t)(num / d);
+#endif
+}
+
+/**
+ * readTsc - Read the CPU timestamp counter. Ticks at a fixed rate on any recent x86, so
+ * it's a cheap, very fine grained clock, but its rate isn't the core clock and isn't
+ * reported anywhere. Calibrate against a real clock before converting to time.
+ *
+ * @return Current timestamp counter, or 0 off x86.
+ */
+
+static inline uint64_t readTsc()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * cpuHasAvx2 - Check at runtime whether the CPU and OS support AVX2.
+ *
+ * @return True if AVX2 code can run.
+ */
+
+static inline bool cpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+
+    __cpuid(regs, 0);
+
+    if (regs[0] < 7)
+    {
+        return false;
+    }
+
+    // OSXSAVE, and the OS saves XMM and YMM state.
+
+    __cpuid(regs, 1);
+
+    if (((regs[2] >> 27) & 1) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(regs, 7, 0);
+
+    return (regs[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * cpuHasAvx2Fma - Check at runtime whether the CPU and OS support AVX2 and FMA3.
+ *
+ * @return True if AVX2 code using fused multiply-adds can run.
+ */
+
+static inline bool cpuHasAvx2Fma()
+{
+#ifdef _MSC_VER
+    int regs[4];
+
+    __cpuid(regs, 0);
+
+    if (regs[0] < 7)
+    {
+        return false;
+    }
+
+    // FMA, OSXSAVE, and the OS saves XMM and YMM state.
+
+    __cpuid(regs, 1);
+
+    if (((regs[2] >> 12) & 1) == 0 || ((regs[2] >> 27) & 1) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(regs, 7, 0);
+
+    return (regs[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+/**
+ * cpuHasAvx512Ifma - Check at runtime whether the CPU and OS support AVX-512F and
+ * AVX-512 IFMA (52-bit integer multiply-add).
+ *
+ * @return True if AVX-512 IFMA code can run.
+ */
+
+static inline bool cpuHasAvx512Ifma()
+{
+#ifdef _MSC_VER
+    int regs[4];
+
+    __cpuid(regs, 0);
+
+    if (regs[0] < 7)
+    {
+        return false;
+    }
+
+    // OSXSAVE, and the OS saves XMM, YMM, opmask and ZMM state.
+
+    __cpuid(regs, 1);
+
+    if (((regs[2] >> 27) & 1) == 0 || (_xgetbv(0) & 0xE6) != 0xE6)
+    {
+        return false;
+    }
+
+    __cpuidex(regs, 7, 0);
+
+    return ((regs[1] >> 16) & 1) && ((regs[1] >> 21) & 1);
+#else
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+#include "intrinsics.h"
+
+/**
+ * Montgomery64 - Modular arithmetic mod an odd 64-bit n with R = 2^64. Values are kept
+ * in Montgomery form aR mod n, so a product is one 128-bit multiply plus a REDC, with no
+ * division. Convert in with ToMont and out with FromMont. Everything in between (Add,
+ * Sub, Mul, Pow, Inverse) takes and returns Montgomery form.
+ *
+ * Usage:
+ *
+ *     Montgomery64 mont;
+ *     mont.Init(n);
+ *
+ *     uint64_t x = mont.Pow(mont.ToMont(b), e);
+ *     uint64_t y = mont.FromMont(x);
+ */
+
+struct Montgomery64
+{
+    uint64_t n;
+    uint64_t nInv;
+    uint64_t one;
+    uint64_t r2;
+
+    void Init(uint64_t nIn);
+    uint64_t Inverse(uint64_t a) const;
+
+    uint64_t Add(uint64_t a, uint64_t b) const
+    {
+        uint64_t sum = a + b;
+        return (sum < a || sum >= n) ? sum - n : sum;
+    }
+
+    uint64_t Sub(uint64_t a, uint64_t b) const
+    {
+        uint64_t diff = a - b;
+        return diff + (n & (0 - (uint64_t)(a < b)));
+    }
+
+    /**
+     * Reduce - REDC of a 128-bit value hi:lo < n * 2^64. With m = lo * n^-1, hi:lo - m * n
+     * has a zero low word, so the result is hi minus the high word of m * n, mod n.
+     */
+
+    uint64_t Reduce(uint64_t hi, uint64_t lo) const
+    {
+        uint64_t m   = lo * nInv;
+        uint64_t mHi = mulHi64(m, n);
+
+        return (hi - mHi) + (n & (0 - (uint64_t)(hi < mHi)));
+    }
+
+    uint64_t Mul(uint64_t a, uint64_t b) const
+    {
+        uint64_t hi;
+        uint64_t lo = mul128(a, b, hi);
+
+        return Reduce(hi, lo);
+    }
+
+    uint64_t ToMont(uint64_t a) const
+    {
+        return Mul(a % n, r2);
+    }
+
+    uint64_t FromMont(uint64_t a) const
+    {
+        return Reduce(0, a);
+    }
+
+    uint64_t Pow(uint64_t base, uint64_t e) const
+    {
+        uint64_t result = one;
+
+        while (e > 0)
+        {
+            if (e & 1)
+            {
+                result = Mul(result, base);
+            }
+
+            base = Mul(base, base);
+            e >>= 1;
+        }
+
+        return result;
+    }
+};
+
+/**
+ * Barrett64 - Modular arithmetic mod any n < 2^62, including the even moduli Montgomery
+ * can't handle. Values stay as plain residues. A product a * b is reduced with
+ * mu = floor(2^128 / n): the quotient estimate from the high words of a * b * mu is at
+ * most two short, so two conditional subtracts finish the job without dividing.
+ *
+ * Usage:
+ *
+ *     Barrett64 bar;
+ *     bar.Init(n);
+ *
+ *     uint64_t x = bar.Pow(b % n, e);
+ */
+
+struct Barrett64
+{
+    uint64_t n;
+    uint64_t muHi;
+    uint64_t muLo;
+
+    void Init(uint64_t nIn);
+    uint64_t Inverse(uint64_t a) const;
+
+    uint64_t Add(uint64_t a, uint64_t b) const
+    {
+        uint64_t sum = a + b;
+        return sum - (n & (0 - (uint64_t)(sum >= n)));
+    }
+
+    uint64_t Sub(uint64_t a, uint64_t b) const
+    {
+        uint64_t diff = a - b;
+        return diff + (n & (0 - (uint64_t)(a < b)));
+    }
+
+    /**
+     * Reduce - Reduce a 128-bit value hi:lo < n^2 mod n. The quotient is the high 128 bits
+     * of hi:lo * muHi:muLo. The lowest partial product only feeds a carry into the
+     * middle words, so it's dropped, and the estimate can come up short by up to two.
+     */
+
+    uint64_t Reduce(uint64_t hi, uint64_t lo) const
+    {
+        uint64_t midHi1;
+        uint64_t midLo1 = mul128(lo, muHi, midHi1);
+        uint64_t midHi2;
+        uint64_t midLo2 = mul128(hi, muLo, midHi2);
+
+        uint64_t carry  = (midLo1 + midLo2 < midLo1);
+        uint64_t q      = hi * muHi + midHi1 + midHi2 + carry;
+        uint64_t r      = lo - q * n;
+
+        r -= n & (0 - (uint64_t)(r >= n));
+        r -= n & (0 - (uint64_t)(r >= n));
+
+        return r;
+    }
+
+    uint64_t Mul(uint64_t a, uint64_t b) const
+    {
+        uint64_t hi;
+        uint64_t lo = mul128(a, b, hi);
+
+        return Reduce(hi, lo);
+    }
+
+    uint64_t Pow(uint64_t base, uint64_t e) const
+    {
+        uint64_t result = 1 % n;
+
+        while (e > 0)
+        {
+            if (e & 1)
+            {
+                result = Mul(result, base);
+            }
+
+            base = Mul(base, base);
+            e >>= 1;
+        }
+
+        return result;
+    }
+};
+
+uint64_t gcdBinary64(uint64_t a, uint64_t b);
+uint64_t gcdExtended64(uint64_t a, uint64_t b, int64_t &x, int64_t &y);
+uint64_t inverseMod64(uint64_t a, uint64_t n);
+uint64_t powMod64(uint64_t b, uint64_t e, uint64_t n);
+void powModBatch(const uint64_t* bases, const uint64_t* exps, uint64_t mod, uint64_t* out, size_t n);
+void powModBatch(const uint64_t* bases, uint64_t exp, uint64_t mod, uint64_t* out, size_t n);
+void powModBatchParallel(const uint64_t* bases, const uint64_t* exps, uint64_t mod, uint64_t* out, size_t n);
+void powModBatchParallel(const uint64_t* bases, uint64_t exp, uint64_t mod, uint64_t* out, size_t n);
+
+#ifdef __SIZEOF_INT128__
+unsigned __int128 gcdBinary128(unsigned __int128 a, unsigned __int128 b);
+unsigned __int128 gcdExtended128(unsigned __int128 a, unsigned __int128 b, __int128 &x, __int128 &y);
+#endif
+
+void TestGcd();
+void TestModArith();
\ No newline at end of file
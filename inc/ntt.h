@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <assert.h>
+
+using namespace std;
+
+/**
+ * NTTPlan - Precomputed tables for number theoretic transforms of one power-of-two size
+ * mod one NTT-friendly prime p < 2^30, i.e., one where 2^k divides p - 1 for a large k so
+ * p has roots of unity of every power-of-two order up to 2^k. The NTT is the DFT over
+ * the integers mod p, so a convolution mod p is exact, with no rounding.
+ *
+ * Butterflies multiply in 32-bit Montgomery form (R = 2^32): the roots are stored as
+ * wR mod p, and Mul(x, wR) = xw, so data stays in plain form through a transform and
+ * never needs converting in or out.
+ *
+ * Forward is decimation in frequency, natural order in and bit reversed order out.
+ * Inverse is decimation in time, bit reversed in and natural out, scaled by 1 / size.
+ * Between them a convolution needs no permutation pass. Roots are laid out by stage like
+ * FFTPlan's twiddles: roots[n / 2 + k] = w_n^k for k < n / 2. Stages run 8 butterflies
+ * at a time with AVX2 when the CPU has it.
+ *
+ * Usage:
+ *
+ *     NTTPlan plan;
+ *     plan.Init(998244353, 3, 1024);
+ *
+ *     plan.Forward(a.data());
+ *     plan.Forward(b.data());
+ *     plan.PointwiseMul(a.data(), b.data());
+ *     plan.Inverse(a.data());
+ */
+
+struct NTTPlan
+{
+    uint32_t mod;
+    uint32_t nInv;
+    uint32_t r2;
+    uint32_t size;
+    uint32_t scale;
+    vector<uint32_t> roots;
+    vector<uint32_t> invRoots;
+
+    NTTPlan() : mod(0), size(0) {};
+
+    void Init(uint32_t modIn, uint32_t generator, uint32_t sizeIn);
+    void Forward(uint32_t* pData) const;
+    void Inverse(uint32_t* pData) const;
+    void PointwiseMul(uint32_t* pA, const uint32_t* pB) const;
+
+    uint32_t Add(uint32_t a, uint32_t b) const
+    {
+        uint32_t sum = a + b - mod;
+        return sum + (mod & (0 - (sum >> 31)));
+    }
+
+    uint32_t Sub(uint32_t a, uint32_t b) const
+    {
+        uint32_t diff = a - b;
+        return diff + (mod & (0 - (diff >> 31)));
+    }
+
+    // Everything stays below 2p < 2^31, so Add, Sub and Mul reduce by subtracting p and
+    // adding it back if the sign bit is set, with no branches to mispredict.
+
+    /**
+     * Mul - Montgomery product a * b / 2^32 mod p. With m = ab * -p^-1 mod 2^32, ab + mp
+     * has a zero low word, and for p < 2^30 the shifted sum is below 2p.
+     */
+
+    uint32_t Mul(uint32_t a, uint32_t b) const
+    {
+        uint64_t prod   = (uint64_t)a * b;
+        uint32_t m      = (uint32_t)prod * nInv;
+        uint32_t res    = (uint32_t)((prod + (uint64_t)m * mod) >> 32) - mod;
+
+        return res + (mod & (0 - (res >> 31)));
+    }
+};
+
+const NTTPlan& GetNTTPlan(uint32_t mod, uint32_t size);
+void convolve(const vector<uint64_t> &a, const vector<uint64_t> &b, vector<uint64_t> &out);
+void convolveMod(const vector<uint64_t> &a, const vector<uint64_t> &b, uint32_t mod, vector<uint64_t> &out);
+
+void TestNTT();
\ No newline at end of file
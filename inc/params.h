@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum ParamType
+{
+    PARAM_U32,
+    PARAM_U64,
+    PARAM_DOUBLE
+};
+
+struct Param
+{
+    string name;
+    ParamType type;
+    void* pValue;
+    uint64_t minValue;
+};
+
+/**
+ * ParamSet - Named view of the fields of a problem's parameter struct, so they can be
+ * read and set by name from the command line. The struct's Bind adds each field, and
+ * the set then writes straight through to it.
+ *
+ * Values are numbers, given plainly or in scientific notation ("500000000" or "5e8").
+ * Integer fields reject anything fractional, negative or out of range, including below
+ * the minimum they were added with.
+ *
+ * Usage:
+ *
+ *     PE512Params params;
+ *     ParamSet set;
+ *     params.Bind(set);
+ *
+ *     set.Set("max", "1e9");
+ */
+
+struct ParamSet
+{
+    vector<Param> params;
+
+    void Add(const char* name, uint32_t &value, uint64_t minValue = 0) { params.push_back({ name, PARAM_U32, &value, minValue }); }
+    void Add(const char* name, uint64_t &value, uint64_t minValue = 0) { params.push_back({ name, PARAM_U64, &value, minValue }); }
+    void Add(const char* name, double &value) { params.push_back({ name, PARAM_DOUBLE, &value, 0 }); }
+
+    Param* Find(const string &name);
+    bool Set(const string &name, const string &text);
+    bool Set(const string &name, double value);
+    double Get(const string &name) const;
+    bool ParseArg(const string &arg, bool &bValid);
+    string ToString() const;
+};
+
+bool parseNumber(const char* pText, double &value);
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Binary prime table file layout. All fields are little-endian.
+ *
+ *     PrimeFileHeader
+ *     PrimeFileCheckpoint[numBlocks]
+ *     uint8_t gaps[gapBytes]
+ *
+ * Primes are stored in blocks of blockSize. Each block's first prime is held in full
+ * in its checkpoint, along with the offset of the block's gaps in the gap stream, and
+ * the rest of the block is delta-encoded. Gaps between odd primes are even, so a byte
+ * holds gap / 2. A zero byte escapes to a two-byte gap / 2 for the rare gaps past 510.
+ * The one odd gap, 2 -> 3, is stored as 1 and implied on decode.
+ *
+ * At one byte per prime plus 16 bytes per block, primes up to 1e8 take about 6MB, and
+ * the checkpoints make "first prime >= x" a binary search plus at most one block of
+ * decoding.
+ */
+
+static const uint32_t primeFileMagic       = 0x534D5250;
+static const uint32_t primeFileVersion     = 1;
+static const uint32_t primeFileBlockSize   = 128;
+
+struct PrimeFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+    uint64_t maxPrime;
+    uint32_t blockSize;
+    uint32_t numBlocks;
+    uint64_t gapBytes;
+};
+
+struct PrimeFileCheckpoint
+{
+    uint64_t prime;
+    uint64_t offset;
+};
+
+/**
+ * PrimeFile - Read-only view of a binary prime table, memory mapped so opening it costs
+ * nothing up front and primes are decoded straight out of the mapping.
+ *
+ * Usage:
+ *
+ *     PrimeFile file;
+ *
+ *     if (file.Open("primes.bin"))
+ *     {
+ *         file.ForEachPrime(min, max, [&](uint64_t p)
+ *         {
+ *             ...
+ *         });
+ *     }
+ */
+
+struct PrimeFile
+{
+    const uint8_t* pBase;
+    size_t size;
+    void* hFile;
+    void* hMapping;
+
+    const PrimeFileHeader* pHeader;
+    const PrimeFileCheckpoint* pCheckpoints;
+    const uint8_t* pGaps;
+
+    PrimeFile() : pBase(nullptr), size(0), hFile(nullptr), hMapping(nullptr),
+        pHeader(nullptr), pCheckpoints(nullptr), pGaps(nullptr) {};
+    ~PrimeFile() { Close(); }
+
+    bool Open(const char* fileName);
+    void Close();
+    uint64_t LowerBound(uint64_t x, uint64_t &index) const;
+
+    uint64_t Count() const { return pHeader ? pHeader->count : 0; }
+    uint64_t MaxPrime() const { return pHeader ? pHeader->maxPrime : 0; }
+
+    /**
+     * FindBlock - Get the last block whose first prime is no greater than x.
+     *
+     * @param x Value to search for.
+     *
+     * @return Block index. Zero if x is below every prime.
+     */
+
+    uint32_t FindBlock(uint64_t x) const
+    {
+        const PrimeFileCheckpoint* pEnd = pCheckpoints + pHeader->numBlocks;
+
+        const PrimeFileCheckpoint* pBlock = upper_bound(pCheckpoints, pEnd, x,
+            [](uint64_t val, const PrimeFileCheckpoint &cp) { return val < cp.prime; });
+
+        return (pBlock == pCheckpoints) ? 0 : (uint32_t)(pBlock - pCheckpoints - 1);
+    }
+
+    /**
+     * ForEachPrime - Call back on every prime in the file in [min, max], in order,
+     * decoding from the block containing min onward.
+     *
+     * @param min      Smallest value to report.
+     * @param max      Largest value to report.
+     * @param callback Called with each prime.
+     */
+
+    template<typename F>
+    void ForEachPrime(uint64_t min, uint64_t max, F callback) const
+    {
+        if (Count() == 0 || min > max)
+        {
+            return;
+        }
+
+        uint64_t blockSize  = pHeader->blockSize;
+        uint64_t index      = (uint64_t)FindBlock(min) * blockSize;
+        uint64_t count      = pHeader->count;
+
+        const uint8_t* pGap = pGaps + pCheckpoints[index / blockSize].offset;
+        uint64_t p          = pCheckpoints[index / blockSize].prime;
+
+        while (true)
+        {
+            if (p > max)
+            {
+                return;
+            }
+
+            if (p >= min)
+            {
+                callback(p);
+            }
+
+            if (++index == count)
+            {
+                return;
+            }
+
+            if (index % blockSize == 0)
+            {
+                p = pCheckpoints[index / blockSize].prime;
+                continue;
+            }
+
+            uint32_t halfGap = *pGap++;
+
+            if (halfGap == 0)
+            {
+                halfGap = (uint32_t)pGap[0] | ((uint32_t)pGap[1] << 8);
+                pGap    += 2;
+            }
+
+            p = (p == 2) ? 3 : p + 2 * (uint64_t)halfGap;
+        }
+    }
+};
\ No newline at end of file
@@ -9,6 +9,10 @@
 #include <assert.h>
 #include <iostream>
 #include <fstream>
+#include <math.h>
+#include <algorithm>
+#include <mutex>
+#include "intrinsics.h"
 
 using namespace std;
 
@@ -24,15 +28,411 @@ struct primePower64
 	uint64_t power;
 };
 
-void writePrimesToFile(const char* fileName, vector<uint32_t> &primes);
-void readPrimesFromFile(const char* fileName, vector<uint32_t> &primes, uint32_t max);
-void readPrimesFromFile(const char* fileName, unordered_set<uint32_t> &primes, uint32_t max);
+// Mod-30 wheel. Only values coprime to 30 can be prime (past 2, 3, and 5), and there
+// are exactly 8 such residues, so one byte covers 30 integers with bit k standing for
+// 30 * byte + wheel30[k]. wheel30BitIndex maps a residue back to its bit, or 0xFF if
+// that residue is a multiple of 2, 3, or 5.
+
+static const uint8_t wheel30[8] = { 1, 7, 11, 13, 17, 19, 23, 29 };
+
+static const uint8_t wheel30BitIndex[30] =
+{
+    0xFF, 0,    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 1,    0xFF, 0xFF,
+    0xFF, 2,    0xFF, 3,    0xFF, 0xFF, 0xFF, 4,    0xFF, 5,
+    0xFF, 0xFF, 0xFF, 6,    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 7
+};
+
+// wheel30MaskUpTo[r] has the bits set for every wheel residue <= r.
+
+static const uint8_t wheel30MaskUpTo[30] =
+{
+    0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03,
+    0x03, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x1F, 0x1F, 0x3F,
+    0x3F, 0x3F, 0x3F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0xFF
+};
+
+// Number of wheel bytes sieved per segment. 32KB covers ~1M integers and stays
+// resident in L1 while it's being marked.
+
+static const uint32_t sieveSegmentBytes = 1 << 15;
+
+/**
+ * SegmentedSieve - Sieve of Eratosthenes over [min, max] that only ever holds one
+ * cache-sized segment of the range. Segments are stored as mod-30 wheel bytes, with
+ * a set bit meaning prime. Sieving primes up to sqrt(max) are computed once in Init,
+ * along with the next multiple of each prime still to be crossed off and where it is
+ * on the wheel. Each call to NextSegment picks up where the last one left off, so the
+ * working set is the segment plus the sieving primes regardless of how big max is.
+ *
+ * Usage:
+ *
+ *     SegmentedSieve sieve;
+ *     sieve.Init(min, max);
+ *
+ *     while (sieve.NextSegment())
+ *     {
+ *         sieve.ForEachPrime([&](uint64_t p) { ... });
+ *     }
+ */
+
+struct SegmentedSieve
+{
+    uint64_t min;
+    uint64_t max;
+    uint64_t low;
+    uint64_t endByte;
+    bool started;
+    bool hasSmall;
+
+    vector<uint32_t> sievingPrimes;
+    vector<uint64_t> nextBytes;
+    vector<uint8_t> wheelIdx;
+    vector<uint8_t> segment;
+
+    void Init(uint64_t minIn, uint64_t maxIn);
+    void Init(uint64_t minIn, uint64_t maxIn, const vector<uint32_t> &primes);
+    bool NextSegment();
+
+    /**
+     * ForEachPrime - Call a function on each prime in the current segment, in
+     * increasing order. Walk the segment 8 bytes at a time and peel off set bits.
+     *
+     * @param callback Called with each prime found as a uint64_t.
+     */
+
+    template<typename F> void ForEachPrime(F callback) const
+    {
+        if (hasSmall)
+        {
+            for (uint64_t p : { 2, 3, 5 })
+            {
+                if (p >= min && p <= max)
+                {
+                    callback(p);
+                }
+            }
+        }
+
+        const uint8_t* pBytes   = segment.data();
+        const size_t numBytes   = segment.size();
+        size_t i                = 0;
+
+        for (; i + 8 <= numBytes; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, pBytes + i, sizeof(word));
+
+            while (word)
+            {
+                uint32_t bit = ctz64(word);
+                word &= word - 1;
+                callback(30 * (low + i + (bit >> 3)) + wheel30[bit & 7]);
+            }
+        }
+
+        for (; i < numBytes; i++)
+        {
+            uint64_t byte = pBytes[i];
+
+            while (byte)
+            {
+                uint32_t bit = ctz64(byte);
+                byte &= byte - 1;
+                callback(30 * (low + i) + wheel30[bit]);
+            }
+        }
+    }
+};
+
+/**
+ * PrimeIterator - Lazy prime generator. Primes are sieved a window at a time as the
+ * iterator walks off either end of what it has, so memory stays at one window plus
+ * the sieving primes no matter how far it goes. Windows start small so the first prime
+ * comes back right away, and grow as iteration continues.
+ *
+ * Init(start) puts the cursor just before start. Next() then returns primes >= start in
+ * increasing order, and Prev() returns primes < start in decreasing order. Like any
+ * bidirectional cursor, Prev() right after Next() returns the same prime again. Both
+ * return 0 once they run out, below 2 or past primeIteratorLimit.
+ *
+ * Usage:
+ *
+ *     PrimeIterator primes;
+ *     primes.Init(start);
+ *
+ *     for (uint64_t p = primes.Next(); p <= max; p = primes.Next())
+ *     {
+ *         ...
+ *     }
+ */
+
+static const uint64_t primeIteratorLimit = 0x7FFFFFFFFFFFFFFFULL;
+
+struct PrimeIterator
+{
+    uint64_t lo;
+    uint64_t end;
+    uint64_t windowSize;
+    size_t pos;
+    uint32_t baseMax;
+
+    vector<uint64_t> window;
+    vector<uint32_t> basePrimes;
+    SegmentedSieve sieve;
+
+    void Init(uint64_t start = 0);
+    void Fill(uint64_t loIn, uint64_t endIn);
+    void Grow();
+
+    /**
+     * Next - Get the next prime up, sieving the next window first if needed.
+     *
+     * @return Next prime, or 0 past primeIteratorLimit.
+     */
+
+    uint64_t Next()
+    {
+        while (pos == window.size())
+        {
+            if (end > primeIteratorLimit)
+            {
+                return 0;
+            }
+
+            uint64_t windowEnd = (primeIteratorLimit - end < windowSize) ? primeIteratorLimit + 1 : end + windowSize;
+
+            Fill(end, windowEnd);
+            pos = 0;
+            Grow();
+        }
+
+        return window[pos++];
+    }
+
+    /**
+     * Prev - Get the next prime down, sieving the previous window first if needed.
+     *
+     * @return Previous prime, or 0 once there are none left.
+     */
+
+    uint64_t Prev()
+    {
+        while (pos == 0)
+        {
+            if (lo == 0)
+            {
+                return 0;
+            }
+
+            Fill(lo > windowSize ? lo - windowSize : 0, lo);
+            pos = window.size();
+            Grow();
+        }
+
+        return window[--pos];
+    }
+};
+
+/**
+ * PrimeBitset - Bit-packed table of the primes up to max for O(1) lookups. Uses the
+ * same mod-30 wheel bytes as the segmented sieve, so it takes max / 30 bytes, about
+ * 3.3MB for primes up to 1e8. InitCounts adds a running prime count for every 8 bytes
+ * (another max / 60 bytes) so pi(n) is also O(1): a table lookup and a popcount.
+ */
+
+struct PrimeBitset
+{
+    uint64_t max;
+    vector<uint8_t> bits;
+    vector<uint32_t> wordCounts;
+
+    void Init(uint64_t maxIn);
+    void InitCounts();
+
+    /**
+     * countPrimes - Count the primes up to n. Needs InitCounts.
+     *
+     * @param n Count primes up to and including this value. Must be no greater than max.
+     *
+     * @return pi(n).
+     */
+
+    uint64_t countPrimes(uint64_t n) const
+    {
+        assert(n <= max && wordCounts.size() > 0);
+
+        if (n < 7)
+        {
+            return (n >= 2) + (n >= 3) + (n >= 5);
+        }
+
+        uint64_t byte   = n / 30;
+        uint64_t word   = byte / 8;
+        uint32_t shift  = 8 * (uint32_t)(byte % 8);
+
+        uint64_t bitsWord = 0;
+        memcpy(&bitsWord, &bits[(size_t)(8 * word)], (size_t)(byte % 8) + 1);
+
+        uint64_t mask = (((uint64_t)1 << shift) - 1) | ((uint64_t)wheel30MaskUpTo[n % 30] << shift);
+
+        return 3 + wordCounts[(size_t)word] + popcount64(bitsWord & mask);
+    }
+
+    /**
+     * isPrime - Check if a value is a prime.
+     *
+     * @param n Value to check.
+     *
+     * @return True if n is a prime no greater than max, false otherwise.
+     */
+
+    bool isPrime(uint64_t n) const
+    {
+        if (n > max)
+        {
+            return false;
+        }
+
+        if (n < 7)
+        {
+            return n == 2 || n == 3 || n == 5;
+        }
+
+        uint8_t bit = wheel30BitIndex[n % 30];
+
+        if (bit == 0xFF)
+        {
+            return false;
+        }
+
+        return (bits[n / 30] >> bit) & 1;
+    }
+};
+
+/**
+ * SpfFactorIterator - Walk the prime factorization of a value using a smallest prime
+ * factor table from spfSieve. Each step reads spf[n], divides out every power of that
+ * prime, and yields it as a primePower, so factors come out in increasing order with
+ * no allocation.
+ *
+ * Usage:
+ *
+ *     SpfFactorIterator it(spf, n);
+ *     primePower factor;
+ *
+ *     while (it.Next(factor))
+ *     {
+ *         ...
+ *     }
+ */
+
+struct SpfFactorIterator
+{
+    const uint32_t* pSpf;
+    uint32_t value;
+
+    SpfFactorIterator(const vector<uint32_t> &spf, uint32_t n) : pSpf(spf.data()), value(n)
+    {
+        assert(n < spf.size());
+    };
+
+    bool Next(primePower &factor)
+    {
+        if (value <= 1)
+        {
+            return false;
+        }
+
+        uint32_t p      = pSpf[value];
+        factor.prime    = p;
+        factor.power    = 0;
+
+        do
+        {
+            value /= p;
+            factor.power++;
+        } while (pSpf[value] == p);
+
+        return true;
+    }
+};
+
+/**
+ * Flags selecting which functions MultiplicativeTable fills in.
+ */
+
+static const uint32_t MULT_TOTIENT       = 0x1;
+static const uint32_t MULT_MOBIUS        = 0x2;
+static const uint32_t MULT_DIVISORCOUNT  = 0x4;
+static const uint32_t MULT_DIVISORSUM    = 0x8;
+static const uint32_t MULT_RADICAL       = 0x10;
+
+/**
+ * MultiplicativeTable - Flat tables of multiplicative functions (Euler's totient, Mobius,
+ * divisor count, divisor sum and radical) over a range of values. Only the functions
+ * asked for are allocated and filled.
+ *
+ * Init(max, funcs) covers [0, max] with a linear (Euler) sieve: every composite is
+ * reached exactly once as i * p with p its smallest prime, and f(i * p) comes from
+ * f(i), f(i / p) and f(p), so the whole table is O(max).
+ *
+ * Init(min, max, funcs, primes) covers just the window [min, max], for ranges too big
+ * to hold at once. Each base prime divides its multiples out of a residual (with exact
+ * division by the prime's inverse mod 2^64), and whatever residual is left at the end is
+ * one prime above sqrt(max). Step windows across the range to stream through it.
+ *
+ * Divisor sums wrap past 2^64 for values near 2^64.
+ *
+ * Usage:
+ *
+ *     MultiplicativeTable table;
+ *     table.Init(max, MULT_TOTIENT | MULT_DIVISORSUM);
+ *
+ *     uint64_t phi    = table.Totient(n);
+ *     uint64_t sigma  = table.DivisorSum(n);
+ */
+
+struct MultiplicativeTable
+{
+    uint64_t min;
+    uint64_t max;
+    uint32_t funcs;
+
+    vector<uint64_t> totient;
+    vector<int8_t> mobius;
+    vector<uint32_t> divisorCount;
+    vector<uint64_t> divisorSum;
+    vector<uint64_t> radical;
+
+    void Init(uint32_t maxIn, uint32_t funcsIn);
+    void Init(uint64_t minIn, uint64_t maxIn, uint32_t funcsIn, const vector<uint32_t> &primes);
+    void Alloc(uint64_t minIn, uint64_t maxIn, uint32_t funcsIn);
+
+    uint64_t Totient(uint64_t n) const { return totient[(size_t)(n - min)]; }
+    int8_t Mobius(uint64_t n) const { return mobius[(size_t)(n - min)]; }
+    uint32_t DivisorCount(uint64_t n) const { return divisorCount[(size_t)(n - min)]; }
+    uint64_t DivisorSum(uint64_t n) const { return divisorSum[(size_t)(n - min)]; }
+    uint64_t Radical(uint64_t n) const { return radical[(size_t)(n - min)]; }
+};
+
+bool writePrimesToFile(const char* fileName, const vector<uint32_t> &primes);
+bool readPrimesFromFile(const char* fileName, vector<uint32_t> &primes, uint32_t max);
+bool readPrimesFromFile(const char* fileName, unordered_set<uint32_t> &primes, uint32_t max);
 void primeSieve(uint32_t max, vector<uint32_t> &primes);
 void primeSieve(uint64_t max, vector<uint64_t> &primes);
 void primeSieve(uint32_t min, uint32_t max, vector<uint32_t> &primes);
+void primeSieve(uint64_t min, uint64_t max, vector<uint64_t> &primes);
 void primeSieve(uint32_t max, unordered_set<uint32_t> &primes);
+void primeSieveParallel(uint32_t min, uint32_t max, vector<uint32_t> &primes, uint32_t numChunks = 0);
 bool isPrime(uint64_t prime, vector<uint32_t> &primes);
+bool isPrime(uint64_t value);
 uint32_t primePi(uint32_t exponent);
+uint64_t primeCount(uint64_t x);
 void factorSieve(uint32_t max, vector<vector<primePower>> &values);
+void spfSieve(uint32_t max, vector<uint32_t> &spf);
+void factorSpf(const vector<uint32_t> &spf, uint32_t value, vector<primePower> &factors);
 void factorTrialDivision(vector<uint32_t> &primes, vector<primePower> &factors, uint64_t value);
-void factorTrialDivision64(vector<uint64_t> &primes, vector<primePower64> &factors, uint64_t value);
\ No newline at end of file
+void factorTrialDivision64(vector<uint64_t> &primes, vector<primePower64> &factors, uint64_t value);
+void factor64(uint64_t value, vector<primePower64> &factors);
+
+void TestFactor64();
\ No newline at end of file
@@ -1,15 +1,208 @@
+#pragma once
+
 #include "commoninclude.h"
+#include "params.h"
 
 using namespace std;
 
+/**
+ * Problems with a size to scale take a parameter struct. Its defaults are the problem's
+ * own inputs, and Bind names its fields so main can set them from the command line,
+ * e.g. "PE512 --max=1e9".
+ */
+
+/**
+ * PE75Params - Count perimeters up to maxLength made by exactly one right triangle.
+ */
+
+struct PE75Params
+{
+    uint64_t maxLength;
+
+    PE75Params() : maxLength(1500000) {};
+    void Bind(ParamSet &set) { set.Add("maxLength", maxLength); }
+};
+
+/**
+ * PE95Params - Find the longest amicable chain with no element past max.
+ */
+
+struct PE95Params
+{
+    uint32_t max;
+
+    PE95Params() : max((uint32_t)1e6) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE123Params - Find the first n where (p_n - 1)^n + (p_n + 1)^n mod p_n^2 passes limit.
+ */
+
+struct PE123Params
+{
+    uint64_t limit;
+
+    PE123Params() : limit((uint64_t)1e10) {};
+    void Bind(ParamSet &set) { set.Add("limit", limit); }
+};
+
+/**
+ * PE179Params - Count n < max where n and n + 1 have the same number of divisors.
+ */
+
+struct PE179Params
+{
+    uint32_t max;
+
+    PE179Params() : max((uint32_t)1e7) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE187Params - Count semiprimes below max.
+ */
+
+struct PE187Params
+{
+    uint32_t max;
+
+    PE187Params() : max((uint32_t)1e8) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE204Params - Count Hamming numbers of type primeMax up to max. primeMax must be at
+ * least 3.
+ */
+
+struct PE204Params
+{
+    uint64_t max;
+    uint32_t primeMax;
+
+    PE204Params() : max((uint64_t)1e9), primeMax(100) {};
+    void Bind(ParamSet &set) { set.Add("max", max); set.Add("primeMax", primeMax, 3); }
+};
+
+/**
+ * PE313Params - Count sliding puzzle grids solved in p^2 moves, for primes p < primeMax.
+ */
+
+struct PE313Params
+{
+    uint64_t primeMax;
+
+    PE313Params() : primeMax(1000000) {};
+    void Bind(ParamSet &set) { set.Add("primeMax", primeMax); }
+};
+
+/**
+ * PE351Params - Count hidden points in a hexagonal orchard of order max, which must be
+ * at least 1.
+ */
+
+struct PE351Params
+{
+    uint32_t max;
+
+    PE351Params() : max((uint32_t)1e8) {};
+    void Bind(ParamSet &set) { set.Add("max", max, 1); }
+};
+
+/**
+ * PE401Params - Sum sigma2(n) for n up to max.
+ */
+
+struct PE401Params
+{
+    uint64_t max;
+
+    PE401Params() : max((uint64_t)1e15) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE425Params - Sum primes up to max that aren't 2's relatives.
+ */
+
+struct PE425Params
+{
+    uint32_t max;
+
+    PE425Params() : max((uint32_t)1e7) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE479Params - Sum S(k) for k below max, which must be at least 2.
+ */
+
+struct PE479Params
+{
+    uint64_t max;
+
+    PE479Params() : max(1000000) {};
+    void Bind(ParamSet &set) { set.Add("max", max, 2); }
+};
+
+/**
+ * PE512Params - Sum phi(n^i) mod (n + 1) for n up to max.
+ */
+
+struct PE512Params
+{
+    uint64_t max;
+
+    PE512Params() : max((uint64_t)5e8) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE516Params - Sum n up to max whose totient is a Hamming number.
+ */
+
+struct PE516Params
+{
+    uint64_t max;
+
+    PE516Params() : max((uint64_t)1e12) {};
+    void Bind(ParamSet &set) { set.Add("max", max); }
+};
+
+/**
+ * PE518Params - Sum prime triples (a, b, c) with c below max, which must be at least 3.
+ */
+
+struct PE518Params
+{
+    uint32_t max;
+
+    PE518Params() : max((uint32_t)1e8) {};
+    void Bind(ParamSet &set) { set.Add("max", max, 3); }
+};
+
+/**
+ * PE581Params - Sum n up to maxN where n(n + 1) / 2 is primeMax-smooth.
+ */
+
+struct PE581Params
+{
+    uint64_t maxN;
+    uint32_t primeMax;
+
+    PE581Params() : maxN((uint64_t)2e12), primeMax(47) {};
+    void Bind(ParamSet &set) { set.Add("maxN", maxN); set.Add("primeMax", primeMax); }
+};
+
 void PE66();
 void PE68();
-void PE75();
+void PE75(const PE75Params &params);
 void PE77();
 void PE78();
 void PE83();
 void PE91();
-void PE95();
+void PE95(const PE95Params &params);
 void PE96();
 
 void PE100();
@@ -19,37 +212,37 @@ void PE113();
 void PE116();
 void PE119();
 void PE120();
-void PE123();
+void PE123(const PE123Params &params);
 void PE124();
 void PE125();
 void PE173();
-void PE179();
-void PE187();
+void PE179(const PE179Params &params);
+void PE187(const PE187Params &params);
 
 void PE203();
-void PE204();
+void PE204(const PE204Params &params);
 void PE293();
 
-void PE313();
+void PE313(const PE313Params &params);
 void PE329();
 void PE321();
 void PE340();
 void PE348();
-void PE351();
+void PE351(const PE351Params &params);
 void PE358();
 void PE359();
 
-void PE401();
-void PE425();
-void PE479();
+void PE401(const PE401Params &params);
+void PE425(const PE425Params &params);
+void PE479(const PE479Params &params);
 
-void PE512();
-void PE516();
-void PE518();
+void PE512(const PE512Params &params);
+void PE516(const PE516Params &params);
+void PE518(const PE518Params &params);
 void PE531();
 void PE571();
 void PE577();
-void PE581();
+void PE581(const PE581Params &params);
 void PE587();
 
 void PE601();
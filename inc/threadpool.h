@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <assert.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+using namespace std;
+
+/**
+ * ThreadPool - Fixed set of worker threads with one task deque per worker. Submitted
+ * tasks are dealt round-robin onto the deques. Workers pop from the back of their own
+ * deque and, when it runs dry, steal from the front of the others, so a worker that
+ * draws cheap tasks picks up the slack for one that draws expensive ones.
+ *
+ * Tasks can be tagged with a TaskGroup and waited on as a batch. A thread waiting on a
+ * group runs queued tasks until the group is done rather than blocking, so tasks can
+ * submit and wait on their own groups without deadlocking the pool.
+ *
+ * Usage:
+ *
+ *     ThreadPool &pool = GetThreadPool();
+ *     TaskGroup group;
+ *
+ *     for (uint32_t i = 0; i < numTasks; i++)
+ *     {
+ *         pool.Submit([&, i]() { ... }, &group);
+ *     }
+ *
+ *     pool.Wait(group);
+ */
+
+struct TaskGroup
+{
+    atomic<uint64_t> pending;
+
+    TaskGroup() : pending(0) {};
+};
+
+struct ThreadPool
+{
+    struct TaskQueue
+    {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<thread> workers;
+    vector<unique_ptr<TaskQueue>> queues;
+
+    mutex waitLock;
+    condition_variable taskReady;
+    condition_variable tasksDone;
+
+    atomic<uint64_t> queued;
+    atomic<uint64_t> pending;
+    atomic<uint32_t> nextQueue;
+    bool stopping;
+
+    ThreadPool() : queued(0), pending(0), nextQueue(0), stopping(false) {};
+    ~ThreadPool() { Shutdown(); }
+
+    void Init(uint32_t numThreads = 0);
+    void Shutdown();
+    void Submit(function<void()> task, TaskGroup *pGroup = nullptr);
+    void Wait();
+    void Wait(TaskGroup &group);
+
+    uint32_t NumThreads() const { return (uint32_t)workers.size(); }
+
+    void WaitFor(atomic<uint64_t> &counter);
+    bool RunOne(uint32_t home);
+    void WorkerLoop(uint32_t idx);
+};
+
+ThreadPool& GetThreadPool();
+void ParallelFor(uint64_t begin, uint64_t end, function<void(uint64_t)> body);
\ No newline at end of file
@@ -12,8 +12,10 @@
 #include <assert.h>
 #include <complex>
 #include <cmath>
+#include <optional>
 #include "mpirxx.h"
-#include <Windows.h>
+#include "modarith.h"
+#include "benchmark.h"
 
 using namespace std;
 
@@ -28,6 +30,8 @@ struct frac
     mpz_class num;
     mpz_class den;
 
+    void Normalize();
+
     frac& operator=(const frac &rhs)
     {
         num = rhs.num;
@@ -40,11 +44,7 @@ struct frac
         num = num * rhs.den + rhs.num * den;
         den = den * rhs.den;
 
-        mpz_class c;
-        mpz_gcd(c.get_mpz_t(), num.get_mpz_t(), den.get_mpz_t());
-        num /= c;
-        den /= c;
-
+        Normalize();
         return *this;
     }
 
@@ -53,12 +53,7 @@ struct frac
         num *= rhs.num;
         den *= rhs.den;
 
-        mpz_class c;
-        mpz_gcd(c.get_mpz_t(), num.get_mpz_t(), den.get_mpz_t());
-
-        num /= c;
-        den /= c;
-
+        Normalize();
         return *this;
     }
 
@@ -105,6 +100,9 @@ uint64_t gcd64(uint64_t a, uint64_t b);
 double gcdDbl(double a, double b);
 uint32_t gcdExtended(uint32_t a, uint32_t b, uint32_t &x, uint32_t &y);
 int64_t gcdExtended(int64_t a, int64_t b, int64_t &x, int64_t &y);
+bool crtMerge(uint64_t &a, uint64_t &n, uint64_t b, uint64_t m);
+optional<pair<uint64_t, uint64_t>> crt(const vector<pair<uint64_t, uint64_t>> &congruences);
+size_t crtBatch(const uint64_t* as, const uint64_t* ns, const uint64_t* bs, const uint64_t* ms, uint64_t* out, size_t count, uint64_t fallback);
 void getContinuedFraction(uint32_t inVal, continuedFrac &frac);
 void computeKConvergent(continuedFrac &frac, uint64_t k, uint64_t &a, uint64_t &b);
 void computeKConvergentDouble(continuedFrac &frac, uint64_t k, double &a, double &b);
@@ -113,7 +111,6 @@ bool isPalindromic64(uint64_t value);
 void cubicRoots(double a, double b, double c, double d, vector<complex<double>> &roots);
 uint32_t numDigits(uint32_t val);
 uint32_t powMod(uint32_t b, uint32_t e, uint32_t n);
-int64_t powMod64(int64_t b, int64_t e, int64_t n);
 uint64_t geomSum(uint64_t r, uint64_t n);
 
 void convertBase(
@@ -123,4 +120,4 @@ void convertBase(
     uint64_t b2
 );
 
-long long GetMilliseconds();
\ No newline at end of file
+void TestCRT();
\ No newline at end of file
@@ -99,7 +99,7 @@ void PE108()
                 if (solutions.size() >= max)
                 {
                     cout << val << endl;
-                    __debugbreak();
+                    return;
                 }
             }
         }
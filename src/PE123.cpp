@@ -9,36 +9,39 @@
  * term will have a non-zero remainder, (2 * binomial(n, n - 1) * p ) mod p^2 =
  * (2 * n * p ) mod p^2
  *
- * So, just look through primes computing (2 * n * p ) mod p^2
+ * So, just stream through primes computing (2 * n * p ) mod p^2
  * until we hit a value > 1e10;
  *
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return Zero, print result.
  */
 
-void PE123()
+void PE123(const PE123Params &params)
 {
-    const uint64_t maxR = (uint64_t)1e10;
-    const uint64_t maxPrime = (uint64_t)1e6;
+    const uint64_t maxR = params.limit;
 
-    vector<uint64_t> primes;
-    primeSieve(maxPrime, primes);
+    PrimeIterator primes;
+    primes.Init();
 
-    Binomial bi;
+    // Only odd N (even 0-based index n) leave more than 2.
 
-    uint64_t n = 2;
+    uint64_t n = 0;
 
-    while (n < primes.size())
+    for (uint64_t p = primes.Next(); p != 0; p = primes.Next(), n++)
     {
-        uint64_t p = primes[n];
+        if (n < 2 || n % 2 == 1)
+        {
+            continue;
+        }
+
         uint64_t sum = 2 * (n + 1) * p;
         sum %= (p * p);
 
         if (sum > maxR)
         {
             cout << n + 1 << ": " << sum << endl;
-            __debugbreak();
+            return;
         }
-
-        n += 2;
     }
 }
\ No newline at end of file
@@ -1,20 +1,21 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * PE179 - Find the number of values N such that N and N+1 have the same
  * number of divisors.
  * 
- * This solution uses a modified prime sieve that keeps track of prime powers
- * as it sieves out values. Once done, it returns a list from [0,max] of prime
- * factorizations. Using that, compute number of divisors using
- * (k1 + 1)(k2 + 1)...(Kn + 1) from N = p1^(k1)p2^(k2)...p3^(k3).
+ * This solution fills a table of divisor counts for every value up to max with
+ * a linear multiplicative sieve, i.e., (k1 + 1)(k2 + 1)...(Kn + 1) from
+ * N = p1^(k1)p2^(k2)...p3^(k3), then compares neighbours.
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE179()
+void PE179(const PE179Params &params)
 {
-    uint32_t max = (uint32_t)1e7;
-    vector<vector<primePower>> values;
-    factorSieve(max, values);
+    uint32_t max = params.max;
+    MultiplicativeTable table;
+    table.Init(max, MULT_DIVISORCOUNT);
     uint32_t cnt = 0;
 
     uint32_t n1 = 1;
@@ -22,11 +23,7 @@ void PE179()
 
     for (uint32_t i = 2; i < max; i++)
     {
-        n2 = 1;
-        for (uint32_t j = 0; j < values[i].size(); j++)
-        {
-            n2 *= (values[i][j].power + 1);
-        }
+        n2 = table.DivisorCount(i);
 
         if (n2 == n1)
         {
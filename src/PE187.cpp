@@ -1,45 +1,40 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * PE187 - Find the number of values less than 1e8 that have exactly 2,
  * not necessarily distinct, prime powers.
  *
- * Solution is to use a sieve to get primes up to 1e8 / 2. Then, just do a
- * double loop and multiply together all prime pairs. Add a product to the total
- * count if less than 1e8.
+ * Count semiprimes p * q < N with p <= q by their smaller factor. For the
+ * ith prime p (0-based) with p^2 < N, q can be any prime in [p, (N - 1) / p],
+ * and there are pi((N - 1) / p) - i of those. So only primes up to sqrt(N) need
+ * listing, and pi comes from a counting bitset over [0, N / 2].
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE187()
+void PE187(const PE187Params &params)
 {
-    uint32_t max = (uint32_t)1e8;
-    uint32_t cnt = 0;
+    uint32_t max = params.max;
+    uint64_t cnt = 0;
 
     vector<uint32_t> primes;
-    primeSieve(max / 2, primes);
-   
+    primeSieve((uint32_t)sqrt((double)max), primes);
+
+    PrimeBitset primeBits;
+    primeBits.Init(max / 2);
+    primeBits.InitCounts();
+
     for (uint32_t i = 0; i < primes.size(); i++)
     {
-        uint32_t p1 = primes[i];
-        
-        if (p1 * p1 > max)
+        uint64_t p = primes[i];
+
+        if (p * p >= max)
         {
             break;
         }
 
-        for (uint32_t j = i; j < primes.size(); j++)
-        {
-            uint32_t p2 = primes[j];
-            
-            if (p1 * p2 < max)
-            {
-                cnt++;
-            }
-            else
-            {
-                break;
-            }
-        }
+        cnt += primeBits.countPrimes((max - 1) / p) - i;
     }
 
-    printf("%d\n", cnt);
+    printf("%llu\n", cnt);
 }
\ No newline at end of file
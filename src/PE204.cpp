@@ -5,39 +5,38 @@
  * 
  * Pretty straight-forward. Push 1 into an STL set, then interatively insert all
  * primes times the current min value in the set, then remove the min value. Every time
- * we remove a min value, increment the Hamming number count.
+ * we remove a min value, increment the Hamming number count. Stop once the set runs
+ * dry, so max doesn't have to be a Hamming number itself.
  * 
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return Zero, print result.
  */
 
-void PE204()
+void PE204(const PE204Params &params)
 {
     vector<uint64_t> primes;
-    primeSieve(100, primes);
-    const uint64_t maxHNum = (uint64_t)1e9;
+    primeSieve(params.primeMax, primes);
+    const uint64_t maxHNum = params.max;
     set<uint64_t> hNums;
 
-    uint64_t hNumCnt = 1;
+    uint64_t hNumCnt = 0;
 
     hNums.insert(1);
 
-    uint64_t min = *hNums.begin();
-    hNums.erase(min);
-
-    while (min < maxHNum)
+    while (!hNums.empty())
     {
+        uint64_t min = *hNums.begin();
+        hNums.erase(min);
         hNumCnt++;
 
         for (auto prime : primes)
         {
-            if (min * prime <= maxHNum)
+            if (min <= maxHNum / prime)
             {
                 hNums.insert(min * prime);
             }
         }
-
-        min = *hNums.begin();
-        hNums.erase(min);
     }
 
     cout << hNumCnt << endl;
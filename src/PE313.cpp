@@ -22,17 +22,19 @@
  * double the solutions for m to get the n > m cases. For m = n, solve the equations simplify
  * to 8m - 11 = p^2.
  *
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return Zero, print result to console.
  */
 
-void PE313()
+void PE313(const PE313Params &params)
 {
-    const uint64_t primeBnd = 1000000;
-    vector<uint64_t> primes;
-    primeSieve(primeBnd, primes);
+    const uint64_t primeBnd = params.primeMax;
+    PrimeIterator primes;
+    primes.Init();
     uint64_t sum = 0;
 
-    for (auto p : primes)
+    for (uint64_t p = primes.Next(); p < primeBnd; p = primes.Next())
     {
         uint64_t k = p * p + 11;
         
@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * PE351 - Find the number of points occluded from the center in an order 1e8
@@ -11,25 +11,30 @@
  * 3/6, 4/8, etc., out to 5e7/1e8). All these points are occluded. Multiply this number
  * by 6 for each of the 6 triangles in a hex grid. Add in 6 * (1e8 - 1) for the six grid
  * legs to get the total.
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE351()
+void PE351(const PE351Params &params)
 {
-    const uint64_t max = (uint64_t)1e8;
+    const uint64_t max = params.max;
     uint64_t sum = 0;
     sum += 6 * (max - 1);
 
-    vector<vector<primePower>> factors;
-    factorSieve(max, factors);
+    vector<uint32_t> spf;
+    spfSieve(params.max, spf);
 
-    for (uint64_t i = 2; i < factors.size(); i++)
+    for (uint64_t i = 2; i <= max; i++)
     {
         uint64_t totient = i;
-        
-        for (uint64_t j = 0; j < factors[i].size(); j++)
+
+        SpfFactorIterator it(spf, (uint32_t)i);
+        primePower factor;
+
+        while (it.Next(factor))
         {
-            totient *= factors[i][j].prime - 1;
-            totient /= factors[i][j].prime;
+            totient *= factor.prime - 1;
+            totient /= factor.prime;
         }
 
         uint64_t occludedLayers = max / i - 1;
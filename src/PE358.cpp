@@ -16,7 +16,7 @@
 void PE358()
 {
     vector<uint32_t> primes;
-    primeSieve(729000000, 730000000, primes);
+    primeSieveParallel(729000000, 730000000, primes);
     uint64_t nines = (uint64_t)1e15 - 1;
 
     for (uint32_t i = 0; i < primes.size(); i++)
@@ -39,7 +39,7 @@ void PE358()
             }
 
             printf("%llu\n", sum);
-            __debugbreak();
+            return;
         }
     }
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * Sum of squares from min to max, inclusive.
@@ -27,30 +27,43 @@ mpz_class squareSum(mpz_class min, mpz_class max)
  * Likewise, all M numbers 10^15 / 3 = 3.33^1014 + 1 to 5^15 will appear as 2 * M^2 in the 
  * final sum, etc.
  * 
- * So, we only need to loop up to the square root of 1e15 and sum contributions from 1 and 2
- * to get the final answer.
+ * So, we only need to loop up to r = floor(sqrt(1e15)). Each N <= r is added directly as
+ * (1e15 / N) * N^2. Every N > r divides fewer than r + 1 numbers, so the N > r with
+ * 1e15 / N = i form the range (1e15 / (i + 1), 1e15 / i], clipped to N > r, and go in as
+ * i times their sum of squares.
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE401()
+void PE401(const PE401Params &params)
 {
-    uint64_t max    = (uint64_t)1e15;
-    mpz_class sum    = max;
+    uint64_t max    = params.max;
+    uint64_t r      = (uint64_t)sqrt((double)max);
+    mpz_class sum   = 0;
+
+    while (r * r > max)
+    {
+        r--;
+    }
 
-    for (uint64_t i = 2; i * i < max; i++)
-    {   
-        mpz_class k1 = max / (i - 1);
-        mpz_class k2 = max / i;
+    while ((r + 1) * (r + 1) <= max)
+    {
+        r++;
+    }
+
+    for (uint64_t i = 1; i <= r; i++)
+    {
+        mpz_class k1 = max / i;
+        uint64_t k2  = max / (i + 1);
+        uint64_t lo  = (k2 > r) ? k2 : r;
 
-        sum += k2 * i * i;
-        
-        sum += (i - 1) * squareSum(k2 + 1, k1);
+        sum += k1 * i * i;
 
-        if ((i + 1) * (i + 1) > max && i + 1 <= k2)
+        if (lo < max / i)
         {
-            mpz_class k3 = max / (i + 1);
-            sum += k3 * (i + 1) * (i + 1);
+            sum += i * squareSum(lo + 1, k1);
         }
     }
 
     printf("%s\n", sum.get_str().c_str());
-} 
\ No newline at end of file
+}
@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * getConnections - Given a prime value, replace all its digits and add/remove
@@ -7,14 +7,14 @@
  * @param val         Value to generate connections for.
  * @param connections Vector to hold connections found for val.
  * @param primes      List of prime numbers up to a maximum value.
- * @param isPrime     Boolean vector to quickly look up whether a new value is a prime.
+ * @param primeBits   Prime bitset to quickly look up whether a new value is a prime.
  */
 
 void getConnections(
     uint32_t val,
     vector<uint32_t> &connections,
     vector<uint32_t> &primes,
-    vector<bool> &isPrime
+    const PrimeBitset &primeBits
 )
 {
     uint32_t tmp = val;
@@ -67,7 +67,7 @@ void getConnections(
                 newVal += digits[k] * pwrs[k];
             }
 
-            if (isPrime[newVal])
+            if (primeBits.isPrime(newVal))
             {
                 connections.push_back(newVal);
             }
@@ -87,7 +87,7 @@ void getConnections(
             break;
         }
 
-        if (isPrime[newVal])
+        if (primeBits.isPrime(newVal))
         {
             connections.push_back(newVal);
         }
@@ -99,7 +99,7 @@ void getConnections(
     {
         uint32_t newVal = val % pwr2;
 
-        if (newVal > pwr2 / 10 && isPrime[newVal])
+        if (newVal > pwr2 / 10 && primeBits.isPrime(newVal))
         {
             connections.push_back(newVal);
         }
@@ -178,22 +178,20 @@ void GetMinPathValues(
  * Once that's done, loop through primes and sum that ones that weren't reached or whose max path val
  * is greater than that prime.
  *
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return [description]
  */
 
-void PE425()
+void PE425(const PE425Params &params)
 {
     vector<uint32_t> primes;
-    const uint32_t max = (uint32_t)1e7;
+    const uint32_t max = params.max;
 
     primeSieve(max, primes);
     uint64_t sum = 0;
-    vector<bool> isPrime(10 * max, false);
-
-    for (auto i : primes)
-    {
-        isPrime[i] = true;
-    }
+    PrimeBitset primeBits;
+    primeBits.Init(max);
 
     map<uint32_t, uint32_t> maxPathVals;
     map<uint32_t, vector<uint32_t>> connections;
@@ -201,7 +199,7 @@ void PE425()
     for (uint32_t i = 0; i < primes.size(); i++)
     {
         vector<uint32_t> curConnections;
-        getConnections(primes[i], curConnections, primes, isPrime);
+        getConnections(primes[i], curConnections, primes, primeBits);
         connections[primes[i]] = curConnections;
     }
 
@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * PE479 - Get roots a, b, and c of 1/x = (k/x)^2 * (k + x^2) - kx.
@@ -8,29 +8,44 @@
  * sequence of -3, -8, -15, -24, i.e., start at three and subtract r, r + 2, r + 4.
  * So, no need to solve cubics. The sum on p can be collapsed into a geometric series
  * (1 - p^n+1) / (1 - p) - 1. Compute these terms and be careful with modular arithmetic.
+ * Generate every q up front, then run both sets of exponentiations (q^(n + 1), and
+ * (1 + q)^(m - 2) for the inverse) as batches, vectorized and spread across the pool.
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE479()
+void PE479(const PE479Params &params)
 {
-    uint64_t max    = 1000000;
-    uint64_t sum    = 0;
+    uint64_t max    = params.max;
+    uint64_t m      = 1000000007;
     uint64_t term   = 3;
     uint64_t q      = 3;
-    uint64_t m      = 1000000007;
+    uint64_t sum    = 0;
+
+    vector<uint64_t> nums(max - 1);
+    vector<uint64_t> dens(max - 1);
 
     for (uint64_t i = 1; i < max; i++)
     {
-        uint64_t num = 1 + powMod64(q, max + 1, m);
-        uint64_t den = powMod64(1 + q, m - 2, m);
-        uint64_t k   = ((num * den) - 1) % m;
-
-        sum += k;
-        sum %= m;
+        nums[i - 1] = q;
+        dens[i - 1] = (1 + q) % m;
 
         term += 2;
         q += term;
         q %= m;
     }
 
+    powModBatchParallel(nums.data(), max + 1, m, nums.data(), nums.size());
+    powModBatchParallel(dens.data(), m - 2, m, dens.data(), dens.size());
+
+    for (uint64_t i = 0; i < nums.size(); i++)
+    {
+        uint64_t num = 1 + nums[i];
+        uint64_t k   = ((num * dens[i]) - 1) % m;
+
+        sum += k;
+        sum %= m;
+    }
+
     printf("%llu\n", sum);
 }
\ No newline at end of file
@@ -1,81 +1,53 @@
-#include "commoninclude.h"
-
-/**
- * geomSeriesMod - Compute the geometric series on powers of r up to n modulo m
- * recursively.
- * 
- * @param  r Base for geometric series terms.
- * @param  n Max power of r.
- * @param  m Modulus to take for this geometric series.
- * @return   Result of geometric series mod m.
- */
-
-uint64_t geomSeriesMod(uint64_t r, uint64_t n, uint64_t m)
-{
-    if (n == 0)
-    {
-        return 1;
-    }
-
-    if (n % 2 == 0)
-    {
-        uint64_t s = 1 + ((r + r * r) % m) * (geomSeriesMod(r * r, (n - 2) / 2, m) % m);
-        return s;
-    }
-    else
-    {
-        uint64_t s = ((1 + r) % m) * (geomSeriesMod(r * r, (n - 1) / 2, m) % m);
-        return s;
-    }
-}
+#include "problems.h"
+#include "threadpool.h"
 
 /**
  * PE512 - Find the sum of phi(n^i) mod (n + 1) for i = 1 to n, n = 1 to 5 * 10^8.
  * 
  * Use the observation phi(n^i) = n^(i - 1) * n * ((p_k - 1) / (p_k)) =
  * n^(i - 1) * phi(n). The sum over i then collapses to a geometric series on powers of
- * n, which gets multiplied by phi(n). Use a sieve to compute phi for n up to 5 * 10^8.
- * Use a recursive geometric series function to compute geometric series values mod n + 1.
- * At first, I tried to use direct modular arithmetic, but 1 - n in (1 - n^n) / (1 - n)
- * doesn't always have a modular inverse. Recursion is slow, but gets the right answer.
+ * n, which gets multiplied by phi(n). Since n = -1 mod n + 1, the series
+ * 1 + n + ... + n^(n - 1) alternates 1, -1, ... and is 1 mod n + 1 for odd n and 0 for
+ * even n, so no modular exponentiation is needed at all. Since phi(n) < n + 1, the
+ * answer is just the sum of phi(n) over odd n. Compute phi for n up to 5 * 10^8 with a
+ * segmented multiplicative sieve, with windows spread across the thread pool, so the
+ * totients never all sit in memory.
  * 
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return Print the result, return 0.
  */
 
-void PE512()
+void PE512(const PE512Params &params)
 {
-    uint64_t max = (uint64_t)5e8;
-    uint64_t sum = 1;
+    uint64_t max       = params.max;
+    uint64_t window    = 1 << 18;
 
-    vector<uint64_t> totients(max + 1, 1);
-    totients[0] = 0;
-    totients[1] = 1;
+    vector<uint32_t> primes;
+    primeSieve((uint32_t)sqrt((double)max) + 1, primes);
 
-    for (uint64_t n = 2; n <= max; n++)
-    {
-        totients[n] = n;
-    }
+    uint64_t numWindows = (max + window - 1) / window;
+    vector<uint64_t> sums(numWindows, 0);
 
-    for (uint64_t n = 2; n <= max; n++)
+    ParallelFor(0, numWindows, [&](uint64_t w)
     {
-        if (totients[n] == n)
+        uint64_t lo = 1 + w * window;
+        uint64_t hi = (lo + window - 1 < max) ? lo + window - 1 : max;
+
+        MultiplicativeTable totients;
+        totients.Init(lo, hi, MULT_TOTIENT, primes);
+
+        for (uint64_t n = lo | 1; n <= hi; n += 2)
         {
-            uint64_t tmp = n;
-            while (tmp <= max)
-            {
-                totients[tmp] /= n;
-                totients[tmp] *= (n - 1);
-                tmp += n;
-            }
+            sums[w] += totients.Totient(n);
         }
-    }
+    });
+
+    uint64_t sum = 0;
 
-    for (uint64_t n = 2; n <= max; n++)
+    for (uint64_t s : sums)
     {
-        uint64_t m = n + 1;
-        uint64_t a = geomSeriesMod(n, n - 1, m);
-        uint64_t b = totients[n];
-        sum += (a * b) % m;
+        sum += s;
     }
 
     printf("%llu\n", sum);
@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * generateHammingNumbers - Generate ordered sequence of numbers whose only
@@ -79,19 +79,17 @@ void generateHammingNumbers(uint64_t max, vector<uint64_t> &hammingNumbers)
  * number.
  *
  * @param hammingNumbers List of Hamming numbers to check.
- * @param primes List of primes to use for trial divisions in prime check.
  * @param hammingPrimes (out) Generated Hamming primes.
  */
 
 void getHammingPrimes(
     vector<uint64_t> &hammingNumbers,
-    vector<uint32_t> &primes,
     vector<uint64_t> &hammingPrimes
 )
 {
     for (uint32_t i = 0; i < hammingNumbers.size(); i++)
     {
-        if (isPrime(hammingNumbers[i] + 1, primes) &&
+        if (isPrime(hammingNumbers[i] + 1) &&
             hammingNumbers[i] + 1 > 5)
         {
             hammingPrimes.push_back(hammingNumbers[i] + 1);
@@ -109,13 +107,14 @@ struct primeProduct
  * PE516 - Find the sum mod 2^32 of all numbers N up to 10^12 such that
  * the Euler totient of N is a Hamming number (i.e., phi(N) = 2^i * 3^j * 5^k).
  *
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return Sum mod 2^32 of Ns with Hamming totients.
  */
 
-void PE516()
+void PE516(const PE516Params &params)
 {
-    uint64_t max        = (uint64_t)1e12;
-    uint64_t maxPrime   = (uint64_t)1e6;
+    uint64_t max        = params.max;
     uint64_t sum        = 0;
     uint64_t modulus    = 0x100000000;
 
@@ -124,11 +123,9 @@ void PE516()
 
     vector<uint64_t> hammingNumbers;
     vector<uint64_t> hammingPrimes;
-    vector<uint32_t> primes;
 
     generateHammingNumbers(max, hammingNumbers);
-    primeSieve((uint32_t)maxPrime, primes);
-    getHammingPrimes(hammingNumbers, primes, hammingPrimes);
+    getHammingPrimes(hammingNumbers, hammingPrimes);
 
     // Generate all combinations of products of Hamming primes less
     // than 1e12.
@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 /**
  * PE518 - Find the sum of prime triplets (a, b, c) with
@@ -6,33 +6,49 @@
  * a geometric progression.
  *
  * This code is slow (~7 mins, debug build on a Core i7-5930K).
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE518()
+void PE518(const PE518Params &params)
 {
-    uint32_t max = (uint32_t)1e8;
+    uint32_t max = params.max;
     uint64_t sum = 0;
 
-    // Load all primes up to 1e8 into a hash table for faster lookup
-    // when searching begins. Hashing all the primes up to 1e8 takes ~1 minute.
+    // Load all primes up to max from the binary prime table, sieving and
+    // caching them on the first run, and keep a prime bitset for fast lookup
+    // when searching begins. A table left by a run with a smaller max gets
+    // the missing primes sieved onto its end.
 
     vector<uint32_t> primes;
-    readPrimesFromFile("primes.txt", primes, max);
-    unordered_set<uint32_t> hashedPrimes;
-    hashedPrimes.reserve(primes.size());
 
-    for (uint32_t i = 0; i < primes.size(); i++)
+    if (!readPrimesFromFile("primes.bin", primes, max))
     {
-        hashedPrimes.insert(primes[i]);
+        primeSieve(max, primes);
+        writePrimesToFile("primes.bin", primes);
     }
+    else if (primes.empty() || primes.back() < max)
+    {
+        vector<uint32_t> tail;
+        primeSieve(primes.empty() ? 2 : primes.back() + 1, max, tail);
+
+        if (!tail.empty())
+        {
+            primes.insert(primes.end(), tail.begin(), tail.end());
+            writePrimesToFile("primes.bin", primes);
+        }
+    }
+
+    PrimeBitset primeBits;
+    primeBits.Init(max);
 
-    // Compute all square numbers up to 1e8 for determining search
+    // Compute all square numbers up to max for determining search
     // ranges later.
 
-    const uint32_t numSquares = 10001;
-    uint32_t squares[numSquares];
+    const uint32_t numSquares = (uint32_t)sqrt((double)max) + 3;
+    vector<uint64_t> squares(numSquares);
 
-    for (uint32_t i = 1; i < numSquares; i++)
+    for (uint64_t i = 1; i < numSquares; i++)
     {
         squares[i] = i * i;
     }
@@ -40,14 +56,14 @@ void PE518()
     // This method takes every prime p, determines factors (a/b), and
     // computes triples (p + 1), (a/b) * (p + 1), (a/b)^2 * (p + 1).
     // If (a/b) * (p + 1) - 1 and (a/b)^2 * (p + 1) - 1 are each prime
-    // (i.e., they're in the hash table of known primes), we've found a triple.
+    // (i.e., they're set in the prime bitset), we've found a triple.
     //
     // The expensive part is searching (a/b) candidates. They are determined
     // with the inequality b < a < b * sqrt (1e8 + 1 / p + 1). The bs must satisfy
     // b^2 | (p + 1) (since the third prime in a triple is of the form
     // (a/b)^2 * (p + 1) - 1), so pick the largest b that satisfies this condition.
 
-    for (uint32_t i = 0; i < primes.size() - 2; i++)
+    for (uint32_t i = 0; i + 2 < primes.size(); i++)
     {
         uint32_t b = 1;
         uint32_t p = primes[i] + 1;
@@ -79,8 +95,7 @@ void PE518()
             uint32_t p2 = (p / b) * a - 1;
             uint32_t p3 = (p / (b * b)) * a * a - 1;
             
-            if (hashedPrimes.find(p2) != hashedPrimes.end() &&
-                hashedPrimes.find(p3) != hashedPrimes.end())
+            if (primeBits.isPrime(p2) && primeBits.isPrime(p3))
             {
                 sum += (p - 1) + p2 + p3;
             }
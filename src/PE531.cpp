@@ -1,117 +1,54 @@
 #include "commoninclude.h"
 
-/**
- * Solve LC - Find minimum non-negative x that solves x = a mod n, x = b mod m. Return
- * 0 zero if no solution is found. Solution is found by forward and back substitution of
- * x = a + k * n and x = b + l * m, eliminating GCDs along the way. Once one solution is
- * found, subtract off extra factors of m * n / GCG(m, n) to get minimum solution.
- * 
- * @param  a 
- * @param  n 
- * @param  b 
- * @param  m 
- * @return Minimum non-negative solution to x = a mod n, x = b mod m.
- */
-
-uint64_t SolveLC(int64_t a, int64_t n, int64_t b, int64_t m)
-{
-    int64_t c = (int64_t)gcd((uint32_t)n, (uint32_t)m);
-    int64_t d = b - a;
-
-    if (d < 0)
-    {
-        int64_t k = -d / m;
-        d += (k + 1) * m;
-    }
-    
-    if (d % c != 0)
-    {
-        return 0;
-    }
-
-    d /= c;
-    int64_t n2 = n / c;
-    int64_t m2 = m / c;
-
-    int64_t x;
-    int64_t y;
-
-    gcdExtended(n2, m2, x, y);
-
-    d *= x;
-    
-    if (d < 0)
-    {
-        int64_t k = -d / m2;
-        d += (k + 1) * m2;
-    }
-
-    int64_t out = d * n + a;
-    
-    if (out > m * n2)
-    {
-        int64_t k = out / (m * n2);
-        out -= (k * m * n2);
-    }
-
-    return out;
-}
-
 /**
  * PE 531 - For 1000000 <= n < m < 1005000, sum minimum non-negative solution to
  * linear congruences x = phi(n) mod n and x = phi(m) mod m. First, compute totients up
- * to 1005000. Then, loop over n and m solving linear congruences with SolveLC.
+ * to 1005000 with a linear sieve. Then, for each n, solve the congruences against every
+ * larger m in one batch with crtBatch, reusing the same row buffers throughout. Pairs
+ * with no solution count as 0.
  * 
  * @return Zero. Print answer to problem to console.
  */
 
 void PE531()
 {
+    uint64_t min = 1000000;
     uint64_t max = 1005000;
     uint64_t sum = 0;
 
-    vector<uint64_t> totients(max + 1, 1);
-    totients[0] = 0;
-    totients[1] = 1;
+    MultiplicativeTable totients;
+    totients.Init((uint32_t)max, MULT_TOTIENT);
+
+    size_t rowSize = (size_t)(max - min);
 
-    for (uint64_t n = 2; n <= max; n++)
+    vector<uint64_t> as(rowSize);
+    vector<uint64_t> ns(rowSize);
+    vector<uint64_t> bs(rowSize);
+    vector<uint64_t> ms(rowSize);
+    vector<uint64_t> xs(rowSize);
+
+    for (uint64_t m = min; m < max; m++)
     {
-        totients[n] = n;
+        bs[m - min] = totients.Totient(m);
+        ms[m - min] = m;
     }
 
-    for (uint64_t n = 2; n <= max; n++)
+    for (uint64_t n = min; n < max; n++)
     {
-        if (totients[n] == n)
+        size_t count = (size_t)(max - n - 1);
+
+        for (size_t i = 0; i < count; i++)
         {
-            uint64_t tmp = n;
-            while (tmp <= max)
-            {
-                totients[tmp] /= n;
-                totients[tmp] *= (n - 1);
-                tmp += n;
-            }
+            as[i] = totients.Totient(n);
+            ns[i] = n;
         }
-    }
-    
-    for (uint64_t n = 1000000; n < max; n++)
-    {
-        for (uint64_t m = n + 1; m < max; m++)
-        {
-            uint64_t tn = totients[n];
-            uint64_t tm = totients[m];
-            uint64_t x = SolveLC(tn, n, tm, m);
-
-            if (x % n != tn && x != 0)
-            {
-                __debugbreak();
-            }
 
-            if (x % m != tm && x != 0)
-            {
-                __debugbreak();
-            }
+        size_t first = (size_t)(n + 1 - min);
+        crtBatch(as.data(), ns.data(), &bs[first], &ms[first], xs.data(), count, 0);
 
-            sum += x;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += xs[i];
         }
     }
 
@@ -77,13 +77,16 @@ struct KSmoothGenerator
  * loop through the generated list looking for pairs of consecutive k-smooth values. These
  * are triangle numbers.
  *
+ * @param params Problem size. Defaults to the problem as posed.
+ *
  * @return Zero. Print sum to console.
  */
 
-void PE581()
+void PE581(const PE581Params &params)
 {
-    vector<uint64_t> smallPrimes = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47 };
-    uint64_t maxN = (uint64_t)2e12;
+    vector<uint64_t> smallPrimes;
+    primeSieve(params.primeMax, smallPrimes);
+    uint64_t maxN = params.maxN;
     KSmoothGenerator kgen;
     kgen.Init(smallPrimes, maxN);
 
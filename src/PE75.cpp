@@ -1,4 +1,4 @@
-#include "commoninclude.h"
+#include "problems.h"
 
 struct triple
 {
@@ -14,12 +14,14 @@ struct triple
  * This is another clunky solution. It generates all prime triples that sum up to
  * 1,500,000 using Euclid's formula, removing duplicates along the way. When done, count
  * all the lengths where only one triple was found.
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  */
 
-void PE75()
+void PE75(const PE75Params &params)
 {
-    uint64_t maxLength = 1500000;
-    uint64_t maxM = 867;
+    uint64_t maxLength = params.maxLength;
+    uint64_t maxM = (uint64_t)sqrt(maxLength / 2.0) + 1;
     uint64_t sum = 0;
 
     vector<vector<triple>> triples(maxLength + 1);
@@ -7,42 +7,25 @@
 
 void PE77()
 {
-    vector<uint32_t> primes;
     const uint32_t max = (uint32_t)1e4;
-    primeSieve(max, primes);
-    uint32_t numPrimes = (uint32_t)primes.size();
-    vector<vector<uint32_t>> counts(numPrimes + 1, vector<uint32_t>(max + 1));
+    vector<uint64_t> counts(max + 1, 0);
 
     // There's only one way to sum to zero (i.e., an empty set of primes).
 
-    for (uint32_t primeCnt = 0; primeCnt < numPrimes; primeCnt++)
-    {
-        counts[primeCnt][0] = 1;
-    }
-
-    // There are no ways to sum to any amount using zero primes.
+    counts[0] = 1;
 
-    for (uint32_t amt = 1; amt <= max; amt++)
-    {
-        counts[0][amt] = 0;
-    }
+    // This is a DP "count ways to make change" problem. Stream primes in
+    // increasing order, and after each one, counts[amt] is the number of ways to
+    // write amt as a sum of the primes seen so far.
 
-    // This is a DP "count ways to make change" problem. Count the
-    // number of ways N can be written as a sum of 1 prime, 2 primes, etc.
+    PrimeIterator primes;
+    primes.Init();
 
-    for (uint32_t primeCnt = 1; primeCnt <= numPrimes; primeCnt++)
+    for (uint64_t p = primes.Next(); p <= max; p = primes.Next())
     {
-        for (uint32_t amt = 1; amt <= max; amt++)
+        for (uint32_t amt = (uint32_t)p; amt <= max; amt++)
         {
-            if (primes[primeCnt - 1] <= amt)
-            {
-                counts[primeCnt][amt] = counts[primeCnt][amt - primes[primeCnt - 1]] +
-                    counts[primeCnt - 1][amt];
-            }
-            else
-            {
-                counts[primeCnt][amt] = counts[primeCnt - 1][amt];
-            }
+            counts[amt] += counts[amt - p];
         }
     }
 
@@ -50,13 +33,10 @@ void PE77()
 
     for (uint32_t amt = 1; amt <= max; amt++)
     {
-        for (uint32_t primeCnt = 1; primeCnt <= numPrimes; primeCnt++)
+        if (counts[amt] >= 5000)
         {
-            if (counts[primeCnt][amt] >= 5000)
-            {
-                printf("%d\n", amt);
-                return;
-            }
+            printf("%d\n", amt);
+            return;
         }
     }
 }
\ No newline at end of file
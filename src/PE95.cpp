@@ -4,42 +4,32 @@
  * PE95 Find the smallest value of the longest chain of amicable values
  * below 1e6.
  *
- * First, compute divisor sums of all values up to 1e6. Use a sieve to get
- * prime factorizations, then use property that proper divisor sum of N is 
- * (1 + pk_1 + pk_1^2 ... )(1 + pk_2 + pk_2^2 ... ) - N and formula for 
- * geometric series. After computing these, follow sums, storing ones that
- * form chains. Finally, get the longest chain found and grab its min value.
+ * First, compute divisor sums of all values up to 1e6. Use a linear
+ * multiplicative sieve to get sigma(N) = (1 + pk_1 + pk_1^2 ... )(1 + pk_2 +
+ * pk_2^2 ... ), and the proper divisor sum of N is sigma(N) - N. After computing
+ * these, follow sums, storing ones that form chains. Finally, get the longest
+ * chain found and grab its min value.
+ *
+ * @param params Problem size. Defaults to the problem as posed.
  *
  * @return Zero. Print result to console.
  */
 
-void PE95()
+void PE95(const PE95Params &params)
 {
-    uint64_t max = (uint64_t)1e6;
-    vector<vector<primePower>> primeFactors;
-    factorSieve((uint32_t)max, primeFactors);
+    uint64_t max = params.max;
+    MultiplicativeTable table;
+    table.Init(params.max, MULT_DIVISORSUM);
     vector<uint64_t> divisorSums(max + 1, 0);
     uint64_t min = UINT64_MAX;
 
-    // Get divisor sums from prime factorizations.
+    // Get proper divisor sums from sigma.
 
     vector<vector<uint64_t>> chains;
-    uint64_t n = 0;
 
-    for (auto primes : primeFactors)
+    for (uint64_t n = 2; n <= max; n++)
     {
-        if (n < 2)
-        {
-            divisorSums[n++] = 0;
-            continue;
-        }
-
-        uint64_t sum = 1;
-
-        for (auto prime : primes) sum *= geomSum(prime.prime, prime.power);
-
-        divisorSums[n] = sum - n;
-        n++;
+        divisorSums[n] = table.DivisorSum(n) - n;
     }
 
     // Follow divisor sums to form chains.
@@ -54,7 +44,7 @@ void PE95()
 
         while (find(chain.begin(), chain.end(), next) == chain.end())
         {
-            if (next >= 1000000) break;
+            if (next > max) break;
 
             chain.push_back(next);
             next = divisorSums[next];
@@ -63,19 +53,17 @@ void PE95()
         if (next == chain[0]) chains.push_back(chain);
     }
 
-    // Grab the longest chain (debugging, I happen to know its length is 28) 
-    // and find its min value.
+    // Grab the longest chain (the first found if there's a tie) and find its
+    // min value.
 
-    for (auto chain : chains)
+    size_t longest = 0;
+
+    for (auto& chain : chains)
     {
-        if (chain.size() == 28)
+        if (chain.size() > longest)
         {
-            for (auto val : chain)
-            {
-                if (val < min) min = val;
-            }
-
-            break;
+            longest = chain.size();
+            min     = *min_element(chain.begin(), chain.end());
         }
     }
 
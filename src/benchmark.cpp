@@ -0,0 +1,881 @@
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include "benchmark.h"
+#include "intrinsics.h"
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <io.h>
+#include <Windows.h>
+#include <psapi.h>
+
+static inline int dupFd(int fd) { return _dup(fd); }
+static inline int dup2Fd(int fd, int fd2) { return _dup2(fd, fd2); }
+static inline int closeFd(int fd) { return _close(fd); }
+static inline int fileFd(FILE* pFile) { return _fileno(pFile); }
+static inline FILE* openPipe(const char* command) { return _popen(command, "r"); }
+static inline int closePipe(FILE* pPipe) { return _pclose(pPipe); }
+#else
+#include <unistd.h>
+#include <sys/resource.h>
+
+static inline int dupFd(int fd) { return dup(fd); }
+static inline int dup2Fd(int fd, int fd2) { return dup2(fd, fd2); }
+static inline int closeFd(int fd) { return close(fd); }
+static inline int fileFd(FILE* pFile) { return fileno(pFile); }
+static inline FILE* openPipe(const char* command) { return popen(command, "r"); }
+static inline int closePipe(FILE* pPipe) { return pclose(pPipe); }
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/**
+ * GetNanoseconds - Monotonic wall clock.
+ *
+ * @return Nanoseconds since an arbitrary fixed point. Only differences mean anything.
+ */
+
+uint64_t GetNanoseconds()
+{
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Timer::Start - Start or restart the timer.
+ */
+
+void Timer::Start()
+{
+    startNs = GetNanoseconds();
+}
+
+/**
+ * Timer::ElapsedNs - Time since Start.
+ *
+ * @return Elapsed nanoseconds.
+ */
+
+uint64_t Timer::ElapsedNs() const
+{
+    return GetNanoseconds() - startNs;
+}
+
+#ifdef __linux__
+
+/**
+ * openPerfEvent - Open a counter for one hardware event on the calling thread, in user
+ * and kernel mode, created disabled.
+ *
+ * @param config PERF_COUNT_HW_* event to count.
+ *
+ * @return File descriptor for the counter, or -1 if it can't be opened.
+ */
+
+static int openPerfEvent(uint64_t config)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_hv     = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+#endif
+
+/**
+ * PerfCounters::Open - Open the cycle and cache miss counters. They count the calling
+ * thread only, so work handed off to the thread pool doesn't show up.
+ *
+ * @return True if both counters are open.
+ */
+
+bool PerfCounters::Open()
+{
+    Close();
+
+#ifdef __linux__
+    cyclesFd = openPerfEvent(PERF_COUNT_HW_CPU_CYCLES);
+    missesFd = openPerfEvent(PERF_COUNT_HW_CACHE_MISSES);
+
+    if (cyclesFd < 0 || missesFd < 0)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * PerfCounters::Close - Close any open counters.
+ */
+
+void PerfCounters::Close()
+{
+#ifdef __linux__
+    if (cyclesFd >= 0)
+    {
+        closeFd(cyclesFd);
+    }
+
+    if (missesFd >= 0)
+    {
+        closeFd(missesFd);
+    }
+#endif
+
+    cyclesFd = -1;
+    missesFd = -1;
+}
+
+/**
+ * PerfCounters::Start - Zero the counters and start counting.
+ */
+
+void PerfCounters::Start()
+{
+#ifdef __linux__
+    if (cyclesFd < 0)
+    {
+        return;
+    }
+
+    ioctl(cyclesFd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(missesFd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(cyclesFd, PERF_EVENT_IOC_ENABLE, 0);
+    ioctl(missesFd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+/**
+ * PerfCounters::Stop - Stop counting and read the counts since Start.
+ *
+ * @param cycles      (out) CPU cycles.
+ * @param cacheMisses (out) Last level cache misses.
+ */
+
+void PerfCounters::Stop(uint64_t &cycles, uint64_t &cacheMisses)
+{
+    cycles      = 0;
+    cacheMisses = 0;
+
+#ifdef __linux__
+    if (cyclesFd < 0)
+    {
+        return;
+    }
+
+    ioctl(cyclesFd, PERF_EVENT_IOC_DISABLE, 0);
+    ioctl(missesFd, PERF_EVENT_IOC_DISABLE, 0);
+
+    if (read(cyclesFd, &cycles, sizeof(cycles)) != sizeof(cycles))
+    {
+        cycles = 0;
+    }
+
+    if (read(missesFd, &cacheMisses, sizeof(cacheMisses)) != sizeof(cacheMisses))
+    {
+        cacheMisses = 0;
+    }
+#endif
+}
+
+/**
+ * runBenchmark - Time a function. Run it options.warmup times untimed, then
+ * options.trials times, timing each run on its own. Report the minimum (the best guess
+ * at the true cost), median and 95th percentile (how noisy it is) and mean.
+ *
+ * @param name    Name to report results under.
+ * @param fn      Function to time. Called warmup + trials times, so it needs to be
+ * repeatable.
+ * @param options Warm-up and trial counts, and whether to read hardware counters.
+ *
+ * @return Timing statistics.
+ */
+
+BenchStats runBenchmark(const string &name, function<void()> fn, const BenchOptions &options)
+{
+    BenchStats stats;
+    PerfCounters counters;
+
+    uint32_t trials     = max<uint32_t>(options.trials, 1);
+    stats.name          = name;
+    stats.trials        = trials;
+    stats.hasCounters   = options.counters && counters.Open();
+    stats.cycles        = 0;
+    stats.cacheMisses   = 0;
+
+    for (uint32_t i = 0; i < options.warmup; i++)
+    {
+        fn();
+    }
+
+    vector<uint64_t> tscs(trials);
+    stats.trialMs.resize(trials);
+
+    for (uint32_t i = 0; i < trials; i++)
+    {
+        uint64_t cycles;
+        uint64_t cacheMisses;
+
+        counters.Start();
+
+        uint64_t tsc0   = readTsc();
+        uint64_t t0     = GetNanoseconds();
+
+        fn();
+
+        uint64_t t1     = GetNanoseconds();
+        uint64_t tsc1   = readTsc();
+
+        counters.Stop(cycles, cacheMisses);
+
+        stats.trialMs[i]    = (double)(t1 - t0) / 1e6;
+        tscs[i]             = tsc1 - tsc0;
+        stats.cycles        += cycles;
+        stats.cacheMisses   += cacheMisses;
+    }
+
+    stats.cycles        /= trials;
+    stats.cacheMisses   /= trials;
+
+    vector<double> sorted = stats.trialMs;
+    sort(sorted.begin(), sorted.end());
+    sort(tscs.begin(), tscs.end());
+
+    double sum = 0.0;
+
+    for (double ms : sorted)
+    {
+        sum += ms;
+    }
+
+    uint32_t p95Idx = (uint32_t)ceil(0.95 * trials) - 1;
+
+    stats.minMs     = sorted[0];
+    stats.medianMs  = (trials % 2) ? sorted[trials / 2] : 0.5 * (sorted[trials / 2 - 1] + sorted[trials / 2]);
+    stats.p95Ms     = sorted[p95Idx];
+    stats.meanMs    = sum / trials;
+    stats.medianTsc = tscs[trials / 2];
+
+    return stats;
+}
+
+/**
+ * printBenchStats - Print benchmark results on one line, plus a second for hardware
+ * counters if they were read.
+ *
+ * @param stats Results to print.
+ */
+
+void printBenchStats(const BenchStats &stats)
+{
+    printf("%-12s trials %3u  min %10.3fms  median %10.3fms  p95 %10.3fms  mean %10.3fms  tsc %llu\n",
+        stats.name.c_str(), stats.trials, stats.minMs, stats.medianMs, stats.p95Ms, stats.meanMs,
+        (unsigned long long)stats.medianTsc);
+
+    if (stats.hasCounters)
+    {
+        printf("%-12s cycles %llu  cache misses %llu\n", "",
+            (unsigned long long)stats.cycles, (unsigned long long)stats.cacheMisses);
+    }
+}
+
+/**
+ * OutputCapture::Begin - Start capturing stdout.
+ *
+ * @return True if stdout is now going to the capture file.
+ */
+
+bool OutputCapture::Begin()
+{
+    End();
+
+    fflush(stdout);
+    cout.flush();
+
+    pFile = tmpfile();
+
+    if (pFile == nullptr)
+    {
+        return false;
+    }
+
+    savedFd = dupFd(fileFd(stdout));
+
+    if (savedFd < 0 || dup2Fd(fileFd(pFile), fileFd(stdout)) < 0)
+    {
+        End();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * OutputCapture::End - Stop capturing and put stdout back where it was.
+ *
+ * @return Everything written to stdout since Begin.
+ */
+
+string OutputCapture::End()
+{
+    string output;
+
+    if (pFile == nullptr)
+    {
+        return output;
+    }
+
+    fflush(stdout);
+    cout.flush();
+
+    if (savedFd >= 0)
+    {
+        dup2Fd(savedFd, fileFd(stdout));
+        closeFd(savedFd);
+    }
+
+    rewind(pFile);
+
+    char buf[4096];
+    size_t bytes;
+
+    while ((bytes = fread(buf, 1, sizeof(buf), pFile)) > 0)
+    {
+        output.append(buf, bytes);
+    }
+
+    fclose(pFile);
+
+    savedFd = -1;
+    pFile   = nullptr;
+
+    return output;
+}
+
+/**
+ * getPeakRssKb - Get peak resident set size (peak working set on Windows).
+ *
+ * @return Peak memory in KB over the life of the process.
+ */
+
+uint64_t getPeakRssKb()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return (uint64_t)counters.PeakWorkingSetSize / 1024;
+    }
+
+    return 0;
+#else
+#ifdef __linux__
+    FILE* pStatus = fopen("/proc/self/status", "r");
+
+    if (pStatus)
+    {
+        char line[256];
+        unsigned long long hwm = 0;
+        bool found = false;
+
+        while (!found && fgets(line, sizeof(line), pStatus))
+        {
+            found = (sscanf(line, "VmHWM: %llu kB", &hwm) == 1);
+        }
+
+        fclose(pStatus);
+
+        if (found)
+        {
+            return hwm;
+        }
+    }
+#endif
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    return (uint64_t)usage.ru_maxrss / 1024;
+#else
+    return (uint64_t)usage.ru_maxrss;
+#endif
+#endif
+}
+
+/**
+ * globMatch - Match a string against a shell style pattern, where * matches any run of
+ * characters and ? matches any one character.
+ *
+ * @param pPattern Pattern to match.
+ * @param pStr     String to test.
+ *
+ * @return True if the whole string matches.
+ */
+
+bool globMatch(const char* pPattern, const char* pStr)
+{
+    const char* pStar   = nullptr;
+    const char* pResume = nullptr;
+
+    while (*pStr)
+    {
+        if (*pPattern == '*')
+        {
+            pStar   = pPattern++;
+            pResume = pStr;
+        }
+        else if (*pPattern == '?' || *pPattern == *pStr)
+        {
+            pPattern++;
+            pStr++;
+        }
+        else if (pStar)
+        {
+            pPattern    = pStar + 1;
+            pStr        = ++pResume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pPattern == '*')
+    {
+        pPattern++;
+    }
+
+    return *pPattern == 0;
+}
+
+/**
+ * lastLine - Get the last non-blank line of some text, trimmed. Problems print their
+ * answer last, so this is the answer.
+ *
+ * @param text Text to search.
+ *
+ * @return Last non-blank line, or empty if there isn't one.
+ */
+
+string lastLine(const string &text)
+{
+    size_t end = text.find_last_not_of(" \t\r\n");
+
+    if (end == string::npos)
+    {
+        return string();
+    }
+
+    size_t start = text.find_last_of("\r\n", end);
+    start = (start == string::npos) ? 0 : start + 1;
+
+    size_t first = text.find_first_not_of(" \t", start);
+
+    return text.substr(first, end - first + 1);
+}
+
+/**
+ * readExpectedAnswers - Read a file of expected answers. One "<name> <answer>" per
+ * line. Blank lines and lines starting with # are skipped.
+ *
+ * @param fileName Name of the file.
+ * @param answers  (out) Expected answer for each name.
+ *
+ * @return True if the file could be opened.
+ */
+
+bool readExpectedAnswers(const char* fileName, map<string, string> &answers)
+{
+    ifstream file(fileName);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    string line;
+
+    while (getline(file, line))
+    {
+        size_t nameStart = line.find_first_not_of(" \t");
+
+        if (nameStart == string::npos || line[nameStart] == '#')
+        {
+            continue;
+        }
+
+        size_t nameEnd = line.find_first_of(" \t", nameStart);
+
+        if (nameEnd == string::npos)
+        {
+            continue;
+        }
+
+        string name = line.substr(nameStart, nameEnd - nameStart);
+        answers[name] = lastLine(line.substr(nameEnd));
+    }
+
+    return true;
+}
+
+/**
+ * writeExpectedAnswers - Write a file of expected answers that readExpectedAnswers can
+ * read back.
+ *
+ * @param fileName Name of the file.
+ * @param answers  Answer for each name.
+ *
+ * @return True if the file was written.
+ */
+
+bool writeExpectedAnswers(const char* fileName, const map<string, string> &answers)
+{
+    ofstream file(fileName, ios::out | ios::trunc);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "# Expected answers for --bench. One \"<name> <answer>\" per line.\n";
+
+    for (auto &answer : answers)
+    {
+        file << answer.first << " " << answer.second << "\n";
+    }
+
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * jsonString - Quote and escape a string for JSON.
+ *
+ * @param str String to quote.
+ *
+ * @return JSON string literal.
+ */
+
+static string jsonString(const string &str)
+{
+    string out = "\"";
+
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)c);
+            out += buf;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+
+    return out + "\"";
+}
+
+/**
+ * csvString - Quote a string for CSV, doubling any quotes inside it.
+ *
+ * @param str String to quote.
+ *
+ * @return CSV field.
+ */
+
+static string csvString(const string &str)
+{
+    string out = "\"";
+
+    for (char c : str)
+    {
+        out += c;
+
+        if (c == '"')
+        {
+            out += c;
+        }
+    }
+
+    return out + "\"";
+}
+
+/**
+ * writeBenchJson - Write benchmark suite results as a JSON array, one object per
+ * problem, with every trial's time included.
+ *
+ * @param fileName Name of the file.
+ * @param results  Results to write.
+ *
+ * @return True if the file was written.
+ */
+
+bool writeBenchJson(const char* fileName, const vector<BenchResult> &results)
+{
+    FILE* pFile = fopen(fileName, "w");
+
+    if (pFile == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(pFile, "[\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &result = results[i];
+        const BenchStats &stats   = result.stats;
+
+        fprintf(pFile, "  {\n");
+        fprintf(pFile, "    \"name\": %s,\n", jsonString(stats.name).c_str());
+        fprintf(pFile, "    \"trials\": %u,\n", stats.trials);
+        fprintf(pFile, "    \"minMs\": %.6f,\n", stats.minMs);
+        fprintf(pFile, "    \"medianMs\": %.6f,\n", stats.medianMs);
+        fprintf(pFile, "    \"p95Ms\": %.6f,\n", stats.p95Ms);
+        fprintf(pFile, "    \"meanMs\": %.6f,\n", stats.meanMs);
+        fprintf(pFile, "    \"medianTsc\": %llu,\n", (unsigned long long)stats.medianTsc);
+
+        if (stats.hasCounters)
+        {
+            fprintf(pFile, "    \"cycles\": %llu,\n", (unsigned long long)stats.cycles);
+            fprintf(pFile, "    \"cacheMisses\": %llu,\n", (unsigned long long)stats.cacheMisses);
+        }
+
+        fprintf(pFile, "    \"peakRssKb\": %llu,\n", (unsigned long long)result.peakRssKb);
+        fprintf(pFile, "    \"answer\": %s,\n", jsonString(result.answer).c_str());
+        fprintf(pFile, "    \"expected\": %s,\n", jsonString(result.expected).c_str());
+        fprintf(pFile, "    \"status\": %s,\n", jsonString(result.status).c_str());
+        fprintf(pFile, "    \"trialMs\": [");
+
+        for (size_t j = 0; j < stats.trialMs.size(); j++)
+        {
+            fprintf(pFile, "%s%.6f", j ? ", " : "", stats.trialMs[j]);
+        }
+
+        fprintf(pFile, "]\n  }%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+
+    fprintf(pFile, "]\n");
+
+    bool ok = !ferror(pFile);
+    return (fclose(pFile) == 0) && ok;
+}
+
+/**
+ * writeBenchCsv - Write benchmark suite results as CSV, one row per problem.
+ *
+ * @param fileName Name of the file.
+ * @param results  Results to write.
+ *
+ * @return True if the file was written.
+ */
+
+bool writeBenchCsv(const char* fileName, const vector<BenchResult> &results)
+{
+    FILE* pFile = fopen(fileName, "w");
+
+    if (pFile == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(pFile, "name,trials,minMs,medianMs,p95Ms,meanMs,medianTsc,cycles,cacheMisses,peakRssKb,answer,expected,status\n");
+
+    for (auto &result : results)
+    {
+        const BenchStats &stats = result.stats;
+
+        fprintf(pFile, "%s,%u,%.6f,%.6f,%.6f,%.6f,%llu,%llu,%llu,%llu,%s,%s,%s\n",
+            csvString(stats.name).c_str(), stats.trials,
+            stats.minMs, stats.medianMs, stats.p95Ms, stats.meanMs,
+            (unsigned long long)stats.medianTsc,
+            (unsigned long long)stats.cycles, (unsigned long long)stats.cacheMisses,
+            (unsigned long long)result.peakRssKb,
+            csvString(result.answer).c_str(), csvString(result.expected).c_str(),
+            result.status.c_str());
+    }
+
+    bool ok = !ferror(pFile);
+    return (fclose(pFile) == 0) && ok;
+}
+
+/**
+ * getPhysicalMemoryMb - Get the amount of physical memory installed.
+ *
+ * @return Physical memory in MB, or 0 if it can't be determined.
+ */
+
+uint64_t getPhysicalMemoryMb()
+{
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+
+    return GlobalMemoryStatusEx(&status) ? (uint64_t)(status.ullTotalPhys >> 20) : 0;
+#else
+    long pages     = sysconf(_SC_PHYS_PAGES);
+    long pageSize  = sysconf(_SC_PAGE_SIZE);
+
+    return (pages > 0 && pageSize > 0) ? ((uint64_t)pages * (uint64_t)pageSize) >> 20 : 0;
+#endif
+}
+
+/**
+ * getExecutablePath - Get the path of the running executable, so it can launch copies
+ * of itself.
+ *
+ * @param argv0 argv[0], used if the OS can't say.
+ *
+ * @return Executable path.
+ */
+
+string getExecutablePath(const char* argv0)
+{
+#if defined(_WIN32)
+    char path[MAX_PATH];
+    DWORD len = GetModuleFileNameA(NULL, path, MAX_PATH);
+
+    if (len > 0 && len < MAX_PATH)
+    {
+        return string(path, len);
+    }
+#elif defined(__linux__)
+    char path[4096];
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path));
+
+    if (len > 0 && len < (ssize_t)sizeof(path))
+    {
+        return string(path, (size_t)len);
+    }
+#endif
+
+    return string(argv0);
+}
+
+/**
+ * runCommand - Run a shell command and collect everything it writes to stdout.
+ *
+ * @param command Command line to run.
+ * @param output  (out) The command's stdout.
+ *
+ * @return The command's exit status, 0 for success. -1 if it couldn't be started.
+ */
+
+int runCommand(const string &command, string &output)
+{
+    output.clear();
+
+#ifdef _WIN32
+    // cmd /c strips the outermost quotes from a command line, so add a pair for it
+    // to take off.
+
+    FILE* pPipe = openPipe(("\"" + command + "\"").c_str());
+#else
+    FILE* pPipe = openPipe(command.c_str());
+#endif
+
+    if (pPipe == nullptr)
+    {
+        return -1;
+    }
+
+    char buf[4096];
+    size_t bytes;
+
+    while ((bytes = fread(buf, 1, sizeof(buf), pPipe)) > 0)
+    {
+        output.append(buf, bytes);
+    }
+
+    return closePipe(pPipe);
+}
+
+/**
+ * fitPowerLaw - Fit time = coef * size^k to measured points by least squares on
+ * log(time) against log(size). k is the empirical complexity exponent: about 1 for
+ * linear work, 1.5 for n^1.5, and so on. Fixed start-up costs flatten it at small sizes,
+ * so it means the most over sizes where the run time is well clear of those.
+ *
+ * @param sizes    Input sizes. Must be positive.
+ * @param times    Run time at each size. Must be positive.
+ * @param coef     (out) Fitted constant, in the units of times.
+ * @param rSquared (out) Fraction of the variance in log(time) the fit explains.
+ *
+ * @return Fitted exponent k, or NaN with fewer than two distinct sizes.
+ */
+
+double fitPowerLaw(const vector<double> &sizes, const vector<double> &times, double &coef, double &rSquared)
+{
+    size_t count    = min(sizes.size(), times.size());
+    double sumX     = 0.0;
+    double sumY     = 0.0;
+
+    coef        = NAN;
+    rSquared    = NAN;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        sumX += log(sizes[i]);
+        sumY += log(times[i]);
+    }
+
+    double meanX    = sumX / (double)count;
+    double meanY    = sumY / (double)count;
+    double sxx      = 0.0;
+    double sxy      = 0.0;
+    double syy      = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double dx = log(sizes[i]) - meanX;
+        double dy = log(times[i]) - meanY;
+
+        sxx += dx * dx;
+        sxy += dx * dy;
+        syy += dy * dy;
+    }
+
+    if (count < 2 || sxx == 0.0)
+    {
+        return NAN;
+    }
+
+    double k    = sxy / sxx;
+    coef        = exp(meanY - k * meanX);
+    rSquared    = (syy == 0.0) ? 1.0 : (sxy * sxy) / (sxx * syy);
+
+    return k;
+}
\ No newline at end of file
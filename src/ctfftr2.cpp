@@ -1,6 +1,33 @@
 #include "CTFFTR2.h"
+#include "intrinsics.h"
 
-static const double twoPi       = 6.28318530718;
+#ifdef _MSC_VER
+#define TARGET_AVX2_FMA
+#else
+#include <immintrin.h>
+#define TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#endif
+
+// Fully unroll a loop over a butterfly's points, so its values stay in registers. GCC and
+// Clang only do that at -O3 unless asked; MSVC does it for small constant counts anyway.
+
+#if defined(__GNUC__)
+#define UNROLL_LOOP _Pragma("GCC unroll 16")
+#else
+#define UNROLL_LOOP
+#endif
+
+// Inline a scalar helper into its callers, AVX2 ones included, so it's compiled with their
+// instruction set. Called out of line from AVX2 code, SSE code pays for switching between
+// the two on every call.
+
+#ifdef _MSC_VER
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+static const double twoPi       = 6.283185307179586;
 static const complex<double> I  = complex<double>(0.0, 1.0);
 
 /**
@@ -59,6 +86,29 @@ void GetWaveform(vector<SinusoidsParams> &waves, vector<double> &domain, vector<
     }
 }
 
+/**
+ * GetRealWaveform Generate a real superposition of simple sinusoids, the cosine of each
+ * wave with shift as its phase.
+ *
+ * @param waves   List of input wave amplitudes, frequencies, and phases [in].
+ * @param domain  Domain over which to evaluate input waves [in].
+ * @param samples Superposition of input waves. Assumed empty on input [out].
+ */
+
+void GetRealWaveform(vector<SinusoidsParams> &waves, vector<double> &domain, vector<double> &samples)
+{
+    assert(samples.size() == 0);
+    samples.resize(domain.size(), 0.0);
+
+    for (uint32_t i = 0; i < domain.size(); i++)
+    {
+        for (auto &wave : waves)
+        {
+            samples[i] += wave.amp * cos(twoPi * wave.freq * domain[i] - wave.shift);
+        }
+    }
+}
+
 /**
  * DFTDirect Compute DFT of input waveform by directly evaluating DFT sum.
  *
@@ -69,8 +119,6 @@ void GetWaveform(vector<SinusoidsParams> &waves, vector<double> &domain, vector<
 void DFTDirect(vector<complex<double>> &waveform, vector<complex<double>> &dft)
 {
     assert(dft.size() == 0);
-    bool powerOfTwo = OnetBitSet(waveform.size());
-    assert(powerOfTwo);
 
     dft.resize(waveform.size(), 0.0);
 
@@ -90,134 +138,1873 @@ void DFTDirect(vector<complex<double>> &waveform, vector<complex<double>> &dft)
 }
 
 /**
- * DIT Radix-2 decimiation in time for FFT. Split input into even and odd components,
- * recursively compute N/2 size DFT, then merge results.
+ * initMixedRadix - Factor a size into radices 4, 2, 3, 5 and 7 and build each pass's
+ * twiddles, directly with cos and sin.
+ *
+ * @param plan Plan to set up. Its size must be set [in/out].
  *
- * @param waveform Input wave form to compute FFT DIT computation for [in].
- * @param fft      Results of FFT DIT. Assumed to be empty on input [out].
+ * @return False if the size has any other prime factor, leaving the plan's tables empty.
  */
 
-static void DIT2(vector<complex<double>> &waveform, vector<complex<double>> &fft)
+static bool initMixedRadix(FFTPlan &plan)
 {
-    assert(fft.size() == 0);
+    const uint32_t radices[] = { 4, 2, 3, 5, 7 };
+    uint32_t rest = plan.size;
+
+    for (uint32_t radix : radices)
+    {
+        while (rest % radix == 0)
+        {
+            plan.factors.push_back(radix);
+            rest /= radix;
+        }
+    }
+
+    if (rest != 1)
+    {
+        plan.factors.clear();
+        return false;
+    }
+
+    uint32_t len = 1;
+
+    for (uint32_t radix : plan.factors)
+    {
+        for (uint32_t s = 1; s < radix; s++)
+        {
+            for (uint32_t k = 0; k < len; k++)
+            {
+                double angle = -twoPi * (double)(s * k) / (double)(radix * len);
+                plan.twRe.push_back(cos(angle));
+                plan.twIm.push_back(sin(angle));
+            }
+        }
+
+        len *= radix;
+    }
+
+    return true;
+}
+
+/**
+ * initBluestein - Build the chirp w_2N^(n^2) = e^(-pi i n^2 / N), and the transform of
+ * the sequence it's convolved with, conj(w_2N^(j^2)) for -N < j < N wrapped around a
+ * power-of-two size M >= 2N - 1. That transform is scaled by 1 / M here, to save a pass
+ * inverting the convolution each time.
+ *
+ * @param plan Plan to set up. Its size must be set [in/out].
+ */
+
+static void initBluestein(FFTPlan &plan)
+{
+    uint32_t size       = plan.size;
+    uint32_t convSize   = 1;
+
+    while (convSize < 2 * size - 1)
+    {
+        convSize <<= 1;
+    }
+
+    plan.convPlan = make_shared<FFTPlan>();
+    plan.convPlan->Init(convSize);
+
+    plan.chirpRe.resize(size);
+    plan.chirpIm.resize(size);
+    plan.convRe.assign(convSize, 0.0);
+    plan.convIm.assign(convSize, 0.0);
+
+    // n^2 mod 2N gives the same angle, and keeps it small enough to be exact.
+
+    for (uint32_t n = 0; n < size; n++)
+    {
+        uint64_t sq     = (uint64_t)n * n % (2 * (uint64_t)size);
+        double angle    = -0.5 * twoPi * (double)sq / (double)size;
+
+        plan.chirpRe[n] = cos(angle);
+        plan.chirpIm[n] = sin(angle);
+    }
+
+    double scale = 1.0 / (double)convSize;
+
+    plan.convRe[0] = scale;
+
+    for (uint32_t n = 1; n < size; n++)
+    {
+        plan.convRe[n]              = scale * plan.chirpRe[n];
+        plan.convIm[n]              = -scale * plan.chirpIm[n];
+        plan.convRe[convSize - n]   = plan.convRe[n];
+        plan.convIm[convSize - n]   = plan.convIm[n];
+    }
+
+    plan.convPlan->Execute(plan.convRe.data(), plan.convIm.data(), FFT_SPLIT_RADIX);
+}
+
+/**
+ * FFTPlan::Init - Build the tables for one size. For powers of two, that's the bit
+ * reversal permutation and twiddles. Only the last stage's factors are computed,
+ * directly with cos and sin rather than by repeated rotation so the error doesn't grow
+ * with the size. Every earlier stage's factors are a subset of those,
+ * w_n^k = w_size^(k * size / n), and get copied. Other sizes get mixed radix passes if
+ * they factor into 2, 3, 5 and 7, else Bluestein's algorithm.
+ *
+ * @param sizeIn Transform size, at least 1 [in].
+ */
+
+void FFTPlan::Init(uint32_t sizeIn)
+{
+    assert(sizeIn > 0);
+
+    size = sizeIn;
 
-    uint32_t size = (uint32_t)waveform.size();
-    uint32_t hSize = size / 2;
+    bitReverse.clear();
+    twRe.clear();
+    twIm.clear();
+    tw3Re.clear();
+    tw3Im.clear();
+    factors.clear();
+    convPlan.reset();
+    chirpRe.clear();
+    chirpIm.clear();
+    convRe.clear();
+    convIm.clear();
 
-    if (size == 1)
+    if (!OnetBitSet(size))
     {
-        fft[0] = waveform[0];
+        if (!initMixedRadix(*this))
+        {
+            initBluestein(*this);
+        }
+
         return;
     }
 
-    vector<complex<double>> evenIn(hSize, 0.0);
-    vector<complex<double>> oddIn(hSize, 0.0);
-    vector<complex<double>> evenOut(hSize, 0.0);
-    vector<complex<double>> oddOut(hSize, 0.0);
+    bitReverse.resize(size);
+    twRe.assign(size, 1.0);
+    twIm.assign(size, 0.0);
+    tw3Re.assign(size / 2 + 1, 1.0);
+    tw3Im.assign(size / 2 + 1, 0.0);
+
+    uint32_t numBits = 0;
+
+    while ((1u << numBits) < size)
+    {
+        numBits++;
+    }
+
+    bitReverse[0] = 0;
+
+    for (uint32_t i = 1; i < size; i++)
+    {
+        bitReverse[i] = (bitReverse[i >> 1] >> 1) | ((i & 1) << (numBits - 1));
+    }
+
+    uint32_t top = size / 2;
 
-    fft.resize(size, 0.0);
+    for (uint32_t k = 0; k < top; k++)
+    {
+        double angle    = -twoPi * (double)k / (double)size;
+        twRe[top + k]   = cos(angle);
+        twIm[top + k]   = sin(angle);
+    }
 
-    for (uint32_t i = 0; i < hSize; i++)
+    for (uint32_t half = 1; half < top; half <<= 1)
     {
-        evenIn[i] = waveform[2 * i];
-        oddIn[i] = waveform[2 * i + 1];
+        uint32_t step = top / half;
+
+        for (uint32_t k = 0; k < half; k++)
+        {
+            twRe[half + k] = twRe[top + k * step];
+            twIm[half + k] = twIm[top + k * step];
+        }
     }
 
-    DIT2(evenIn, evenOut);
-    DIT2(oddIn, oddOut);
+    // w_size^3k for 3k past size / 2 is -w_size^(3k - size / 2).
+
+    uint32_t quarter = size / 4;
+
+    for (uint32_t k = 0; k < quarter; k++)
+    {
+        uint32_t m      = 3 * k;
+        double sign     = (m < top) ? 1.0 : -1.0;
+        uint32_t idx    = top + ((m < top) ? m : m - top);
+
+        tw3Re[quarter + k] = sign * twRe[idx];
+        tw3Im[quarter + k] = sign * twIm[idx];
+    }
 
-    for (uint32_t i = 0; i < hSize; i++)
+    for (uint32_t q = 1; q < quarter; q <<= 1)
     {
-        complex<double> twiddle = exp(-(I * twoPi * (double)i) / (double)size);
+        uint32_t step = quarter / q;
 
-        fft[i] = evenOut[i] + twiddle * oddOut[i];
-        fft[i + hSize] = evenOut[i] - twiddle * oddOut[i];
+        for (uint32_t k = 0; k < q; k++)
+        {
+            tw3Re[q + k] = tw3Re[quarter + k * step];
+            tw3Im[q + k] = tw3Im[quarter + k * step];
+        }
     }
 }
 
 /**
- * FFT Compute a simple Cooley-Tukey FFT on power-of-two size input.
+ * FFTPlan::Execute - Forward FFT in place on interleaved complex values. Permute into
+ * bit reversed order, then run log2(size) stages of radix-2 decimation in time
+ * butterflies. Sizes that aren't powers of two go through the split array path. The
+ * complex multiply is written out by hand, since complex<double>'s operator* goes
+ * through a slow library call to handle infinities and NaNs unless the compiler is told
+ * not to care.
  *
- * @param waveform Waveform to compute FFT for [in].
- * @param fft      Result of FFT. Assumed empty on input [out].
+ * @param pData Samples to transform, replaced with their DFT. Must hold size values [in/out].
  */
 
-void FFT(vector<complex<double>> &waveform, vector<complex<double>> &fft)
+void FFTPlan::Execute(complex<double>* pData) const
 {
-    assert(fft.size() == 0);
-    bool powerOfTwo = OnetBitSet(waveform.size());
-    assert(powerOfTwo);
+    if (!OnetBitSet(size))
+    {
+        thread_local vector<double> re;
+        thread_local vector<double> im;
+
+        re.resize(max(re.size(), (size_t)size));
+        im.resize(max(im.size(), (size_t)size));
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            re[i] = pData[i].real();
+            im[i] = pData[i].imag();
+        }
+
+        Execute(re.data(), im.data(), FFT_RADIX2);
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            pData[i] = complex<double>(re[i], im[i]);
+        }
+
+        return;
+    }
 
-    DIT2(waveform, fft);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        uint32_t j = bitReverse[i];
+
+        if (i < j)
+        {
+            swap(pData[i], pData[j]);
+        }
+    }
+
+    for (uint32_t half = 1; half < size; half <<= 1)
+    {
+        const double* pWRe = &twRe[half];
+        const double* pWIm = &twIm[half];
+
+        for (uint32_t start = 0; start < size; start += 2 * half)
+        {
+            complex<double>* pEven  = pData + start;
+            complex<double>* pOdd   = pEven + half;
+
+            for (uint32_t j = 0; j < half; j++)
+            {
+                double xr = pOdd[j].real();
+                double xi = pOdd[j].imag();
+
+                complex<double> t(pWRe[j] * xr - pWIm[j] * xi, pWRe[j] * xi + pWIm[j] * xr);
+
+                pOdd[j]     = pEven[j] - t;
+                pEven[j]    += t;
+            }
+        }
+    }
 }
 
 /**
- * TestDFT Test routine for FFT. Compute both a direct DFT and FFT of simple waveform.
- * Report computation times and compare outputs of both methods.
+ * Split array (SoA) kernels. Every kernel runs on data already in bit reversed order,
+ * where any aligned block of n values holds, in bit reversed order, the inputs of an
+ * n point subtransform, so kernels can be mixed freely from one block size to the next.
+ *
+ * combine4 is the one butterfly behind both radix-4 and split-radix. For a block of
+ * n = 4q points with quarters x0..x3 and k < q, it computes
+ *
+ *     p1 = w_n^k x2,   p3 = w_n^3k x3,   s = p1 + p3,   d = p1 - p3
+ *
+ *     X[k] = a + s,    X[k + q] = b - i d,    X[k + 2q] = a - s,    X[k + 3q] = b + i d
+ *
+ * For radix-4 the quarters are four n / 4 point transforms, and a, b = x0 +- w_n^2k x1.
+ * For split-radix the first half is one n / 2 point transform, so a, b = x0, x1.
  */
 
-void TestDFT()
+static const uint32_t splitRadixLeafSize = 1024;
+
+template<bool radix4>
+static void combine4Scalar(double* pRe, double* pIm, uint32_t q, uint32_t k, uint32_t end,
+    const double* pW1Re, const double* pW1Im, const double* pW2Re, const double* pW2Im,
+    const double* pW3Re, const double* pW3Im)
 {
-    // Generate time domain and test waveform.
+    for (; k < end; k++)
+    {
+        double x0r = pRe[k];
+        double x0i = pIm[k];
+        double x1r = pRe[k + q];
+        double x1i = pIm[k + q];
+        double x2r = pRe[k + 2 * q];
+        double x2i = pIm[k + 2 * q];
+        double x3r = pRe[k + 3 * q];
+        double x3i = pIm[k + 3 * q];
 
-    vector<SinusoidsParams> waves;
-    waves.push_back({ 1.0, 4.0, 0.0 });
+        double p1r = pW1Re[k] * x2r - pW1Im[k] * x2i;
+        double p1i = pW1Re[k] * x2i + pW1Im[k] * x2r;
+        double p3r = pW3Re[k] * x3r - pW3Im[k] * x3i;
+        double p3i = pW3Re[k] * x3i + pW3Im[k] * x3r;
 
-    const uint32_t numSamples = 1024;
-    const double dt = twoPi / (double)numSamples;
+        double ar = x0r;
+        double ai = x0i;
+        double br = x1r;
+        double bi = x1i;
 
-    vector<double> domain;
+        if (radix4)
+        {
+            double p2r = pW2Re[k] * x1r - pW2Im[k] * x1i;
+            double p2i = pW2Re[k] * x1i + pW2Im[k] * x1r;
 
-    for (uint32_t i = 0; i < numSamples; i++)
+            ar = x0r + p2r;
+            ai = x0i + p2i;
+            br = x0r - p2r;
+            bi = x0i - p2i;
+        }
+
+        double sr = p1r + p3r;
+        double si = p1i + p3i;
+        double dr = p1r - p3r;
+        double di = p1i - p3i;
+
+        pRe[k]          = ar + sr;
+        pIm[k]          = ai + si;
+        pRe[k + q]      = br + di;
+        pIm[k + q]      = bi - dr;
+        pRe[k + 2 * q]  = ar - sr;
+        pIm[k + 2 * q]  = ai - si;
+        pRe[k + 3 * q]  = br - di;
+        pIm[k + 3 * q]  = bi + dr;
+    }
+}
+
+/**
+ * combine4Avx2 - combine4Scalar four k at a time, with a scalar tail.
+ */
+
+template<bool radix4>
+TARGET_AVX2_FMA
+static void combine4Avx2(double* pRe, double* pIm, uint32_t q,
+    const double* pW1Re, const double* pW1Im, const double* pW2Re, const double* pW2Im,
+    const double* pW3Re, const double* pW3Im)
+{
+    uint32_t k = 0;
+
+    for (; k + 4 <= q; k += 4)
     {
-        domain.push_back(i * dt);
+        __m256d x0r = _mm256_loadu_pd(pRe + k);
+        __m256d x0i = _mm256_loadu_pd(pIm + k);
+        __m256d x1r = _mm256_loadu_pd(pRe + k + q);
+        __m256d x1i = _mm256_loadu_pd(pIm + k + q);
+        __m256d x2r = _mm256_loadu_pd(pRe + k + 2 * q);
+        __m256d x2i = _mm256_loadu_pd(pIm + k + 2 * q);
+        __m256d x3r = _mm256_loadu_pd(pRe + k + 3 * q);
+        __m256d x3i = _mm256_loadu_pd(pIm + k + 3 * q);
+
+        __m256d w1r = _mm256_loadu_pd(pW1Re + k);
+        __m256d w1i = _mm256_loadu_pd(pW1Im + k);
+        __m256d w3r = _mm256_loadu_pd(pW3Re + k);
+        __m256d w3i = _mm256_loadu_pd(pW3Im + k);
+
+        __m256d p1r = _mm256_fmsub_pd(w1r, x2r, _mm256_mul_pd(w1i, x2i));
+        __m256d p1i = _mm256_fmadd_pd(w1r, x2i, _mm256_mul_pd(w1i, x2r));
+        __m256d p3r = _mm256_fmsub_pd(w3r, x3r, _mm256_mul_pd(w3i, x3i));
+        __m256d p3i = _mm256_fmadd_pd(w3r, x3i, _mm256_mul_pd(w3i, x3r));
+
+        __m256d ar = x0r;
+        __m256d ai = x0i;
+        __m256d br = x1r;
+        __m256d bi = x1i;
+
+        if (radix4)
+        {
+            __m256d w2r = _mm256_loadu_pd(pW2Re + k);
+            __m256d w2i = _mm256_loadu_pd(pW2Im + k);
+            __m256d p2r = _mm256_fmsub_pd(w2r, x1r, _mm256_mul_pd(w2i, x1i));
+            __m256d p2i = _mm256_fmadd_pd(w2r, x1i, _mm256_mul_pd(w2i, x1r));
+
+            ar = _mm256_add_pd(x0r, p2r);
+            ai = _mm256_add_pd(x0i, p2i);
+            br = _mm256_sub_pd(x0r, p2r);
+            bi = _mm256_sub_pd(x0i, p2i);
+        }
+
+        __m256d sr = _mm256_add_pd(p1r, p3r);
+        __m256d si = _mm256_add_pd(p1i, p3i);
+        __m256d dr = _mm256_sub_pd(p1r, p3r);
+        __m256d di = _mm256_sub_pd(p1i, p3i);
+
+        _mm256_storeu_pd(pRe + k, _mm256_add_pd(ar, sr));
+        _mm256_storeu_pd(pIm + k, _mm256_add_pd(ai, si));
+        _mm256_storeu_pd(pRe + k + q, _mm256_add_pd(br, di));
+        _mm256_storeu_pd(pIm + k + q, _mm256_sub_pd(bi, dr));
+        _mm256_storeu_pd(pRe + k + 2 * q, _mm256_sub_pd(ar, sr));
+        _mm256_storeu_pd(pIm + k + 2 * q, _mm256_sub_pd(ai, si));
+        _mm256_storeu_pd(pRe + k + 3 * q, _mm256_sub_pd(br, di));
+        _mm256_storeu_pd(pIm + k + 3 * q, _mm256_add_pd(bi, dr));
     }
 
-    vector<complex<double>> samples;
-    GetWaveform(waves, domain, samples);
+    combine4Scalar<radix4>(pRe, pIm, q, k, q, pW1Re, pW1Im, pW2Re, pW2Im, pW3Re, pW3Im);
+}
 
-    // Time the DFT
+/**
+ * combine4 - Run one combine4 butterfly over a block of 4q points, vectorized when the
+ * CPU allows and q is wide enough to fill a vector.
+ */
 
-    vector<complex<double>> dft;
+template<bool radix4>
+static void combine4(const FFTPlan &plan, double* pRe, double* pIm, uint32_t q, bool avx2)
+{
+    const double* pW1Re = &plan.twRe[2 * q];
+    const double* pW1Im = &plan.twIm[2 * q];
+    const double* pW2Re = &plan.twRe[q];
+    const double* pW2Im = &plan.twIm[q];
+    const double* pW3Re = &plan.tw3Re[q];
+    const double* pW3Im = &plan.tw3Im[q];
+
+    if (avx2 && q >= 4)
+    {
+        combine4Avx2<radix4>(pRe, pIm, q, pW1Re, pW1Im, pW2Re, pW2Im, pW3Re, pW3Im);
+    }
+    else
+    {
+        combine4Scalar<radix4>(pRe, pIm, q, 0, q, pW1Re, pW1Im, pW2Re, pW2Im, pW3Re, pW3Im);
+    }
+}
 
-    long long t1 = GetMilliseconds();
-    DFTDirect(samples, dft);
-    long long t2 = GetMilliseconds();
+/**
+ * radix2Passes - Radix-2 butterflies on every stage of an n point block.
+ */
 
-    printf("DFT time: %gs\n", (double)(t2 - t1) / 1000.0);
+static void radix2Passes(const FFTPlan &plan, double* pRe, double* pIm, uint32_t n)
+{
+    for (uint32_t half = 1; half < n; half <<= 1)
+    {
+        const double* pWRe = &plan.twRe[half];
+        const double* pWIm = &plan.twIm[half];
 
-    vector<double> dftMagnitudes(dft.size(), 0.0);
+        for (uint32_t start = 0; start < n; start += 2 * half)
+        {
+            double* pEvenRe = pRe + start;
+            double* pEvenIm = pIm + start;
+            double* pOddRe  = pEvenRe + half;
+            double* pOddIm  = pEvenIm + half;
 
-    for (uint32_t i = 0; i < dft.size(); i++)
+            for (uint32_t j = 0; j < half; j++)
+            {
+                double tr = pWRe[j] * pOddRe[j] - pWIm[j] * pOddIm[j];
+                double ti = pWRe[j] * pOddIm[j] + pWIm[j] * pOddRe[j];
+
+                pOddRe[j]   = pEvenRe[j] - tr;
+                pOddIm[j]   = pEvenIm[j] - ti;
+                pEvenRe[j]  += tr;
+                pEvenIm[j]  += ti;
+            }
+        }
+    }
+}
+
+/**
+ * radix4Passes - Radix-4 butterflies over an n point block, two stages per pass. An odd
+ * number of stages starts with one radix-2 pass, which needs no twiddles.
+ */
+
+static void radix4Passes(const FFTPlan &plan, double* pRe, double* pIm, uint32_t n, bool avx2)
+{
+    uint32_t q = 1;
+
+    if (n >= 2 && (ctz64(n) & 1))
     {
-        dftMagnitudes[i] = sqrt(dft[i].real() * dft[i].real() + dft[i].imag() * dft[i].imag());
+        for (uint32_t i = 0; i < n; i += 2)
+        {
+            double tr = pRe[i + 1];
+            double ti = pIm[i + 1];
+
+            pRe[i + 1] = pRe[i] - tr;
+            pIm[i + 1] = pIm[i] - ti;
+            pRe[i]     += tr;
+            pIm[i]     += ti;
+        }
+
+        q = 2;
     }
 
-    // Time the FFT
+    // The first radix-4 pass has only unit twiddles, so it's all adds.
 
-    vector<complex<double>> fft;
+    if (q == 1 && n >= 4)
+    {
+        for (uint32_t i = 0; i < n; i += 4)
+        {
+            double ar = pRe[i] + pRe[i + 1];
+            double ai = pIm[i] + pIm[i + 1];
+            double br = pRe[i] - pRe[i + 1];
+            double bi = pIm[i] - pIm[i + 1];
+            double sr = pRe[i + 2] + pRe[i + 3];
+            double si = pIm[i + 2] + pIm[i + 3];
+            double dr = pRe[i + 2] - pRe[i + 3];
+            double di = pIm[i + 2] - pIm[i + 3];
 
-    t1 = GetMilliseconds();
-    FFT(samples, fft);
-    t2 = GetMilliseconds();
+            pRe[i]      = ar + sr;
+            pIm[i]      = ai + si;
+            pRe[i + 1]  = br + di;
+            pIm[i + 1]  = bi - dr;
+            pRe[i + 2]  = ar - sr;
+            pIm[i + 2]  = ai - si;
+            pRe[i + 3]  = br - di;
+            pIm[i + 3]  = bi + dr;
+        }
 
-    printf("FFT time: %gs\n", (double)(t2 - t1) / 1000.0);
+        q = 4;
+    }
 
-    __debugbreak();
+    for (; 4 * q <= n; q *= 4)
+    {
+        for (uint32_t start = 0; start < n; start += 4 * q)
+        {
+            combine4<true>(plan, pRe + start, pIm + start, q, avx2);
+        }
+    }
+}
 
-    vector<double> fftMagnitudes(fft.size(), 0.0);
+/**
+ * splitRadix - Split-radix transform of an n point block: an n / 2 point transform of
+ * the first half and n / 4 point transforms of each remaining quarter, recursively,
+ * then one combine4 pass. Blocks small enough to sit in L1 switch to radix-4, which
+ * has no recursion overhead.
+ */
 
-    for (uint32_t i = 0; i < fft.size(); i++)
+static void splitRadix(const FFTPlan &plan, double* pRe, double* pIm, uint32_t n, bool avx2)
+{
+    if (n <= splitRadixLeafSize)
     {
-        fftMagnitudes[i] = sqrt(fft[i].real() * fft[i].real() + fft[i].imag() * fft[i].imag());
+        radix4Passes(plan, pRe, pIm, n, avx2);
+        return;
     }
 
-    // Compare results
+    uint32_t q = n / 4;
 
-    for (uint32_t i = 0; i < numSamples; i++)
+    splitRadix(plan, pRe, pIm, 2 * q, avx2);
+    splitRadix(plan, pRe + 2 * q, pIm + 2 * q, q, avx2);
+    splitRadix(plan, pRe + 3 * q, pIm + 3 * q, q, avx2);
+
+    combine4<false>(plan, pRe, pIm, q, avx2);
+}
+
+/**
+ * bitReverseBlocked - Bit reversal permutation of one array, in tiles. Write an index
+ * as (a, b, c), where a and c are its top and bottom bitReverseTileBits bits. Reversal
+ * maps (a, b, c) to (rev c, rev b, rev a), so the tiles of all a and c for middles b and
+ * rev b trade places with each other. Each tile is read and written as 2^L runs of 2^L
+ * consecutive values, rather than one value per cache line as the plain swap loop does
+ * once the array outgrows the cache.
+ */
+
+static const uint32_t bitReverseTileBits = 4;
+
+static void bitReverseBlocked(const FFTPlan &plan, double* pData)
+{
+    const uint32_t tile     = 1 << bitReverseTileBits;
+    uint32_t numBits        = ctz64(plan.size);
+    uint32_t rowShift       = numBits - bitReverseTileBits;
+    uint32_t numMiddles     = plan.size >> (2 * bitReverseTileBits);
+
+    double tileA[tile * tile];
+    double tileB[tile * tile];
+    uint32_t revTile[tile];
+
+    for (uint32_t i = 0; i < tile; i++)
     {
-        printf("DFT[%d] = %g, FFT[%d] = %g\n", i, dftMagnitudes[i], i, fftMagnitudes[i]);
+        revTile[i] = plan.bitReverse[i] >> rowShift;
+    }
+
+    for (uint32_t b = 0; b < numMiddles; b++)
+    {
+        uint32_t revB = plan.bitReverse[b << bitReverseTileBits] >> bitReverseTileBits;
+
+        if (revB < b)
+        {
+            continue;
+        }
+
+        double* pRowsA = pData + (b << bitReverseTileBits);
+        double* pRowsB = pData + (revB << bitReverseTileBits);
+
+        for (uint32_t a = 0; a < tile; a++)
+        {
+            memcpy(tileA + a * tile, pRowsA + ((size_t)a << rowShift), tile * sizeof(double));
+            memcpy(tileB + a * tile, pRowsB + ((size_t)a << rowShift), tile * sizeof(double));
+        }
+
+        for (uint32_t a = 0; a < tile; a++)
+        {
+            double* pRowA = pRowsA + ((size_t)a << rowShift);
+            double* pRowB = pRowsB + ((size_t)a << rowShift);
+
+            for (uint32_t c = 0; c < tile; c++)
+            {
+                pRowA[c] = tileB[revTile[c] * tile + revTile[a]];
+                pRowB[c] = tileA[revTile[c] * tile + revTile[a]];
+            }
+        }
+    }
+}
+
+/**
+ * RadixConstants - Factors of a P point DFT, c[q][s] = cos(2 pi sq / P) and s[q][s] the
+ * sine, for the odd radices. Indexed by q and s directly, so the butterflies don't need
+ * sq mod P.
+ */
+
+template<uint32_t P>
+struct RadixConstants
+{
+    double c[P][P];
+    double s[P][P];
+
+    RadixConstants()
+    {
+        UNROLL_LOOP
+        for (uint32_t q = 0; q < P; q++)
+        {
+            for (uint32_t j = 0; j < P; j++)
+            {
+                c[q][j] = cos(twoPi * (double)((q * j) % P) / (double)P);
+                s[q][j] = sin(twoPi * (double)((q * j) % P) / (double)P);
+            }
+        }
     }
+};
 
-    __debugbreak();
+/**
+ * smallDFT - In-place DFT of P points, P in { 2, 3, 4, 5, 7 }. Odd sizes pair each
+ * point s with P - s, whose factors are conjugates, so with sums and differences
+ * t_s +- t_P-s every output pair X_q, X_P-q shares one set of multiplies:
+ *
+ *     X_q = t_0 + sum (t_s + t_P-s) cos(2 pi sq / P) - i sum (t_s - t_P-s) sin(2 pi sq / P)
+ *
+ * and X_P-q is the same with the sign of the sine sum flipped.
+ */
+
+template<uint32_t P>
+static FORCE_INLINE void smallDFT(double* pRe, double* pIm, const RadixConstants<P> &rc)
+{
+    if (P == 2)
+    {
+        double tr = pRe[1];
+        double ti = pIm[1];
+
+        pRe[1] = pRe[0] - tr;
+        pIm[1] = pIm[0] - ti;
+        pRe[0] += tr;
+        pIm[0] += ti;
+    }
+    else if (P == 4)
+    {
+        double ar = pRe[0] + pRe[2];
+        double ai = pIm[0] + pIm[2];
+        double br = pRe[0] - pRe[2];
+        double bi = pIm[0] - pIm[2];
+        double cr = pRe[1] + pRe[3];
+        double ci = pIm[1] + pIm[3];
+        double dr = pRe[1] - pRe[3];
+        double di = pIm[1] - pIm[3];
+
+        pRe[0] = ar + cr;
+        pIm[0] = ai + ci;
+        pRe[1] = br + di;
+        pIm[1] = bi - dr;
+        pRe[2] = ar - cr;
+        pIm[2] = ai - ci;
+        pRe[3] = br - di;
+        pIm[3] = bi + dr;
+    }
+    else
+    {
+        const uint32_t half = (P - 1) / 2;
+
+        double sumRe[half + 1];
+        double sumIm[half + 1];
+        double difRe[half + 1];
+        double difIm[half + 1];
+
+        double x0r = pRe[0];
+        double x0i = pIm[0];
+
+        UNROLL_LOOP
+
+        for (uint32_t s = 1; s <= half; s++)
+        {
+            sumRe[s] = pRe[s] + pRe[P - s];
+            sumIm[s] = pIm[s] + pIm[P - s];
+            difRe[s] = pRe[s] - pRe[P - s];
+            difIm[s] = pIm[s] - pIm[P - s];
+            pRe[0]  += sumRe[s];
+            pIm[0]  += sumIm[s];
+        }
+
+        UNROLL_LOOP
+
+        for (uint32_t q = 1; q <= half; q++)
+        {
+            double ar = x0r;
+            double ai = x0i;
+            double br = 0.0;
+            double bi = 0.0;
+
+            UNROLL_LOOP
+
+            for (uint32_t s = 1; s <= half; s++)
+            {
+                ar += sumRe[s] * rc.c[q][s];
+                ai += sumIm[s] * rc.c[q][s];
+                br += difRe[s] * rc.s[q][s];
+                bi += difIm[s] * rc.s[q][s];
+            }
+
+            pRe[q]      = ar + bi;
+            pIm[q]      = ai - br;
+            pRe[P - q]  = ar - bi;
+            pIm[P - q]  = ai + br;
+        }
+    }
+}
+
+/**
+ * mixedRadixColumn - One group of a Stockham pass, taking the length len DFTs of the
+ * stride P * m subsequences to length P * len DFTs of the stride m ones. Input holds DFT
+ * bin k of subsequence r at k * P * m + r, and output the same with m for P * m. Output
+ * group (k, r) combines P inputs m apart,
+ *
+ *     Y[k + q len][r] = sum_s w_Plen^sk w_P^sq X[k][r + s m]
+ *
+ * @param pSrcRe Real parts of X[k] [in].
+ * @param pSrcIm Imaginary parts of X[k] [in].
+ * @param pDstRe Real parts of Y[k] [out].
+ * @param pDstIm Imaginary parts of Y[k] [out].
+ * @param r      Subsequence [in].
+ * @param stride Distance between outputs, len * m [in].
+ * @param m      Output stride [in].
+ * @param pWr    Real parts of w_Plen^sk, 1 <= s < P [in].
+ * @param pWi    Imaginary parts, likewise [in].
+ * @param rc     Factors of the P point DFT [in].
+ */
+
+template<uint32_t P>
+static FORCE_INLINE void mixedRadixColumn(const double* pSrcRe, const double* pSrcIm, double* pDstRe,
+    double* pDstIm, uint32_t r, size_t stride, uint32_t m, const double* pWr, const double* pWi,
+    const RadixConstants<P> &rc)
+{
+    double xr[P];
+    double xi[P];
+
+    xr[0] = pSrcRe[r];
+    xi[0] = pSrcIm[r];
+
+    UNROLL_LOOP
+
+    for (uint32_t s = 1; s < P; s++)
+    {
+        double vr = pSrcRe[s * m + r];
+        double vi = pSrcIm[s * m + r];
+
+        xr[s] = pWr[s] * vr - pWi[s] * vi;
+        xi[s] = pWr[s] * vi + pWi[s] * vr;
+    }
+
+    smallDFT<P>(xr, xi, rc);
+
+    UNROLL_LOOP
+
+    for (uint32_t q = 0; q < P; q++)
+    {
+        pDstRe[q * stride + r] = xr[q];
+        pDstIm[q * stride + r] = xi[q];
+    }
+}
+
+/**
+ * mixedRadixPass - One Stockham pass, every group of mixedRadixColumn. The inner loop
+ * runs over r, contiguous in both arrays.
+ *
+ * @param pInRe  Real parts in [in].
+ * @param pInIm  Imaginary parts in [in].
+ * @param pOutRe Real parts out [out].
+ * @param pOutIm Imaginary parts out [out].
+ * @param len    Length of the input DFTs [in].
+ * @param m      Output stride, size / (P * len) [in].
+ * @param pWRe   Real parts of this pass's twiddles, w_Plen^sk at (s - 1) len + k [in].
+ * @param pWIm   Imaginary parts, likewise [in].
+ */
+
+template<uint32_t P>
+static void mixedRadixPass(const double* pInRe, const double* pInIm, double* pOutRe,
+    double* pOutIm, uint32_t len, uint32_t m, const double* pWRe, const double* pWIm)
+{
+    static const RadixConstants<P> rc;
+
+    for (uint32_t k = 0; k < len; k++)
+    {
+        double wr[P];
+        double wi[P];
+
+        UNROLL_LOOP
+
+        for (uint32_t s = 1; s < P; s++)
+        {
+            wr[s] = pWRe[(s - 1) * len + k];
+            wi[s] = pWIm[(s - 1) * len + k];
+        }
+
+        for (uint32_t r = 0; r < m; r++)
+        {
+            mixedRadixColumn<P>(pInRe + (size_t)k * P * m, pInIm + (size_t)k * P * m,
+                pOutRe + (size_t)k * m, pOutIm + (size_t)k * m, r, (size_t)len * m, m, wr, wi, rc);
+        }
+    }
+}
+
+/**
+ * smallDFTAvx2 - smallDFT on four groups at once, one per lane, with RadixConstants'
+ * factors broadcast into pC/pS, row by row.
+ */
+
+template<uint32_t P>
+TARGET_AVX2_FMA
+static inline void smallDFTAvx2(__m256d* pRe, __m256d* pIm, const __m256d* pC, const __m256d* pS)
+{
+    if (P == 2)
+    {
+        __m256d tr = pRe[1];
+        __m256d ti = pIm[1];
+
+        pRe[1] = _mm256_sub_pd(pRe[0], tr);
+        pIm[1] = _mm256_sub_pd(pIm[0], ti);
+        pRe[0] = _mm256_add_pd(pRe[0], tr);
+        pIm[0] = _mm256_add_pd(pIm[0], ti);
+    }
+    else if (P == 4)
+    {
+        __m256d ar = _mm256_add_pd(pRe[0], pRe[2]);
+        __m256d ai = _mm256_add_pd(pIm[0], pIm[2]);
+        __m256d br = _mm256_sub_pd(pRe[0], pRe[2]);
+        __m256d bi = _mm256_sub_pd(pIm[0], pIm[2]);
+        __m256d cr = _mm256_add_pd(pRe[1], pRe[3]);
+        __m256d ci = _mm256_add_pd(pIm[1], pIm[3]);
+        __m256d dr = _mm256_sub_pd(pRe[1], pRe[3]);
+        __m256d di = _mm256_sub_pd(pIm[1], pIm[3]);
+
+        pRe[0] = _mm256_add_pd(ar, cr);
+        pIm[0] = _mm256_add_pd(ai, ci);
+        pRe[1] = _mm256_add_pd(br, di);
+        pIm[1] = _mm256_sub_pd(bi, dr);
+        pRe[2] = _mm256_sub_pd(ar, cr);
+        pIm[2] = _mm256_sub_pd(ai, ci);
+        pRe[3] = _mm256_sub_pd(br, di);
+        pIm[3] = _mm256_add_pd(bi, dr);
+    }
+    else
+    {
+        const uint32_t half = (P - 1) / 2;
+
+        __m256d sumRe[half + 1];
+        __m256d sumIm[half + 1];
+        __m256d difRe[half + 1];
+        __m256d difIm[half + 1];
+
+        __m256d x0r = pRe[0];
+        __m256d x0i = pIm[0];
+
+        UNROLL_LOOP
+
+        for (uint32_t s = 1; s <= half; s++)
+        {
+            sumRe[s] = _mm256_add_pd(pRe[s], pRe[P - s]);
+            sumIm[s] = _mm256_add_pd(pIm[s], pIm[P - s]);
+            difRe[s] = _mm256_sub_pd(pRe[s], pRe[P - s]);
+            difIm[s] = _mm256_sub_pd(pIm[s], pIm[P - s]);
+            pRe[0]   = _mm256_add_pd(pRe[0], sumRe[s]);
+            pIm[0]   = _mm256_add_pd(pIm[0], sumIm[s]);
+        }
+
+        UNROLL_LOOP
+
+        for (uint32_t q = 1; q <= half; q++)
+        {
+            __m256d ar = x0r;
+            __m256d ai = x0i;
+            __m256d br = _mm256_setzero_pd();
+            __m256d bi = _mm256_setzero_pd();
+
+            UNROLL_LOOP
+
+            for (uint32_t s = 1; s <= half; s++)
+            {
+                ar = _mm256_fmadd_pd(sumRe[s], pC[q * P + s], ar);
+                ai = _mm256_fmadd_pd(sumIm[s], pC[q * P + s], ai);
+                br = _mm256_fmadd_pd(difRe[s], pS[q * P + s], br);
+                bi = _mm256_fmadd_pd(difIm[s], pS[q * P + s], bi);
+            }
+
+            pRe[q]      = _mm256_add_pd(ar, bi);
+            pIm[q]      = _mm256_sub_pd(ai, br);
+            pRe[P - q]  = _mm256_sub_pd(ar, bi);
+            pIm[P - q]  = _mm256_add_pd(ai, br);
+        }
+    }
+}
+
+/**
+ * mixedRadixPassAvx2 - mixedRadixPass four r at a time, with a scalar tail. The last
+ * passes, where m < 4, are all tail.
+ */
+
+template<uint32_t P>
+TARGET_AVX2_FMA
+static void mixedRadixPassAvx2(const double* pInRe, const double* pInIm, double* pOutRe,
+    double* pOutIm, uint32_t len, uint32_t m, const double* pWRe, const double* pWIm)
+{
+    static const RadixConstants<P> rc;
+
+    __m256d c[P * P];
+    __m256d sn[P * P];
+
+    for (uint32_t j = 0; j < P * P; j++)
+    {
+        c[j]  = _mm256_set1_pd(rc.c[j / P][j % P]);
+        sn[j] = _mm256_set1_pd(rc.s[j / P][j % P]);
+    }
+
+    size_t stride = (size_t)len * m;
+
+    for (uint32_t k = 0; k < len; k++)
+    {
+        const double* pSrcRe    = pInRe + (size_t)k * P * m;
+        const double* pSrcIm    = pInIm + (size_t)k * P * m;
+        double* pDstRe          = pOutRe + (size_t)k * m;
+        double* pDstIm          = pOutIm + (size_t)k * m;
+
+        double wr[P];
+        double wi[P];
+        __m256d wrVec[P];
+        __m256d wiVec[P];
+
+        UNROLL_LOOP
+
+        for (uint32_t s = 1; s < P; s++)
+        {
+            wr[s]       = pWRe[(s - 1) * len + k];
+            wi[s]       = pWIm[(s - 1) * len + k];
+            wrVec[s]    = _mm256_set1_pd(wr[s]);
+            wiVec[s]    = _mm256_set1_pd(wi[s]);
+        }
+
+        uint32_t r = 0;
+
+        for (; r + 4 <= m; r += 4)
+        {
+            __m256d xr[P];
+            __m256d xi[P];
+
+            xr[0] = _mm256_loadu_pd(pSrcRe + r);
+            xi[0] = _mm256_loadu_pd(pSrcIm + r);
+
+            UNROLL_LOOP
+
+            for (uint32_t s = 1; s < P; s++)
+            {
+                __m256d vr = _mm256_loadu_pd(pSrcRe + s * m + r);
+                __m256d vi = _mm256_loadu_pd(pSrcIm + s * m + r);
+
+                xr[s] = _mm256_fmsub_pd(wrVec[s], vr, _mm256_mul_pd(wiVec[s], vi));
+                xi[s] = _mm256_fmadd_pd(wrVec[s], vi, _mm256_mul_pd(wiVec[s], vr));
+            }
+
+            smallDFTAvx2<P>(xr, xi, c, sn);
+
+            UNROLL_LOOP
+
+            for (uint32_t q = 0; q < P; q++)
+            {
+                _mm256_storeu_pd(pDstRe + q * stride + r, xr[q]);
+                _mm256_storeu_pd(pDstIm + q * stride + r, xi[q]);
+            }
+        }
+
+        for (; r < m; r++)
+        {
+            mixedRadixColumn<P>(pSrcRe, pSrcIm, pDstRe, pDstIm, r, stride, m, wr, wi, rc);
+        }
+    }
+}
+
+/**
+ * runMixedRadixPass - Run one pass for a radix, with AVX2 and FMA if the CPU has them.
+ */
+
+template<uint32_t P>
+static void runMixedRadixPass(const double* pInRe, const double* pInIm, double* pOutRe,
+    double* pOutIm, uint32_t len, uint32_t m, const double* pWRe, const double* pWIm, bool avx2)
+{
+    if (avx2)
+    {
+        mixedRadixPassAvx2<P>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm);
+    }
+    else
+    {
+        mixedRadixPass<P>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm);
+    }
+}
+
+/**
+ * mixedRadix - Run every Stockham pass of a mixed radix plan, bouncing between the data
+ * and a scratch array kept per thread, and copy back if the last pass left the result in
+ * scratch.
+ *
+ * @param plan Plan with factors set [in].
+ * @param pRe  Real parts, replaced with the DFT's [in/out].
+ * @param pIm  Imaginary parts, replaced with the DFT's [in/out].
+ * @param avx2 Whether to use AVX2 and FMA [in].
+ */
+
+static void mixedRadix(const FFTPlan &plan, double* pRe, double* pIm, bool avx2)
+{
+    thread_local vector<double> scratchRe;
+    thread_local vector<double> scratchIm;
+
+    scratchRe.resize(max(scratchRe.size(), (size_t)plan.size));
+    scratchIm.resize(max(scratchIm.size(), (size_t)plan.size));
+
+    double* pInRe   = pRe;
+    double* pInIm   = pIm;
+    double* pOutRe  = scratchRe.data();
+    double* pOutIm  = scratchIm.data();
+    uint32_t len    = 1;
+    size_t offset   = 0;
+
+    for (uint32_t radix : plan.factors)
+    {
+        uint32_t m          = plan.size / (radix * len);
+        const double* pWRe  = plan.twRe.data() + offset;
+        const double* pWIm  = plan.twIm.data() + offset;
+
+        switch (radix)
+        {
+        case 2:
+            runMixedRadixPass<2>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm, avx2);
+            break;
+        case 3:
+            runMixedRadixPass<3>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm, avx2);
+            break;
+        case 4:
+            runMixedRadixPass<4>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm, avx2);
+            break;
+        case 5:
+            runMixedRadixPass<5>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm, avx2);
+            break;
+        default:
+            runMixedRadixPass<7>(pInRe, pInIm, pOutRe, pOutIm, len, m, pWRe, pWIm, avx2);
+            break;
+        }
+
+        offset  += (size_t)(radix - 1) * len;
+        len     *= radix;
+
+        swap(pInRe, pOutRe);
+        swap(pInIm, pOutIm);
+    }
+
+    if (pInRe != pRe)
+    {
+        copy(pInRe, pInRe + plan.size, pRe);
+        copy(pInIm, pInIm + plan.size, pIm);
+    }
+}
+
+/**
+ * bluestein - DFT by Bluestein's algorithm. With c_n the chirp,
+ *
+ *     X_k = c_k sum_n (x_n c_n) conj(c_k-n)
+ *
+ * so the sum is a convolution, done as a product of power-of-two transforms. Its
+ * inverse is the conjugate of the forward transform of the conjugate, and the 1 / M is
+ * already in the stored transform.
+ *
+ * @param plan   Plan with Bluestein tables [in].
+ * @param pRe    Real parts, replaced with the DFT's [in/out].
+ * @param pIm    Imaginary parts, replaced with the DFT's [in/out].
+ * @param kernel Kernel for the power-of-two transforms [in].
+ */
+
+static void bluestein(const FFTPlan &plan, double* pRe, double* pIm, FFTKernel kernel)
+{
+    thread_local vector<double> workRe;
+    thread_local vector<double> workIm;
+
+    uint32_t convSize = plan.convPlan->size;
+
+    workRe.resize(max(workRe.size(), (size_t)convSize));
+    workIm.resize(max(workIm.size(), (size_t)convSize));
+
+    for (uint32_t n = 0; n < plan.size; n++)
+    {
+        workRe[n] = pRe[n] * plan.chirpRe[n] - pIm[n] * plan.chirpIm[n];
+        workIm[n] = pRe[n] * plan.chirpIm[n] + pIm[n] * plan.chirpRe[n];
+    }
+
+    fill(workRe.begin() + plan.size, workRe.begin() + convSize, 0.0);
+    fill(workIm.begin() + plan.size, workIm.begin() + convSize, 0.0);
+
+    plan.convPlan->Execute(workRe.data(), workIm.data(), kernel);
+
+    for (uint32_t j = 0; j < convSize; j++)
+    {
+        double ar = workRe[j];
+        double ai = workIm[j];
+
+        workRe[j] = ar * plan.convRe[j] - ai * plan.convIm[j];
+        workIm[j] = -(ar * plan.convIm[j] + ai * plan.convRe[j]);
+    }
+
+    plan.convPlan->Execute(workRe.data(), workIm.data(), kernel);
+
+    for (uint32_t k = 0; k < plan.size; k++)
+    {
+        double cr = workRe[k];
+        double ci = -workIm[k];
+
+        pRe[k] = cr * plan.chirpRe[k] - ci * plan.chirpIm[k];
+        pIm[k] = cr * plan.chirpIm[k] + ci * plan.chirpRe[k];
+    }
+}
+
+/**
+ * FFTPlan::Execute - Forward FFT in place on split real and imaginary arrays, with the
+ * chosen kernel. Radix-4 and split-radix use AVX2 and FMA when the CPU has them. Sizes
+ * that aren't powers of two run mixed radix passes or Bluestein's algorithm instead.
+ *
+ * @param pRe    Real parts, replaced with the DFT's. Must hold size values [in/out].
+ * @param pIm    Imaginary parts, replaced with the DFT's. Must hold size values [in/out].
+ * @param kernel Butterfly scheme to use [in].
+ */
+
+void FFTPlan::Execute(double* pRe, double* pIm, FFTKernel kernel) const
+{
+    static const bool hasAvx2 = cpuHasAvx2Fma();
+
+    if (convPlan)
+    {
+        bluestein(*this, pRe, pIm, kernel);
+        return;
+    }
+
+    if (!factors.empty())
+    {
+        mixedRadix(*this, pRe, pIm, hasAvx2);
+        return;
+    }
+
+    if (size >= (1u << (2 * bitReverseTileBits)))
+    {
+        bitReverseBlocked(*this, pRe);
+        bitReverseBlocked(*this, pIm);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < size; i++)
+        {
+            uint32_t j = bitReverse[i];
+
+            if (i < j)
+            {
+                swap(pRe[i], pRe[j]);
+                swap(pIm[i], pIm[j]);
+            }
+        }
+    }
+
+    switch (kernel)
+    {
+    case FFT_RADIX2:
+        radix2Passes(*this, pRe, pIm, size);
+        break;
+    case FFT_RADIX4:
+        radix4Passes(*this, pRe, pIm, size, hasAvx2);
+        break;
+    default:
+        splitRadix(*this, pRe, pIm, size, hasAvx2);
+        break;
+    }
+}
+
+/**
+ * GetFFTPlan - Get a plan for a size, building it on first use. Plans are cached per
+ * thread, so concurrent callers never share or rebuild each other's tables.
+ *
+ * @param size Transform size, at least 1 [in].
+ *
+ * @return Plan for that size. Stays valid for the life of the calling thread.
+ */
+
+const FFTPlan& GetFFTPlan(uint32_t size)
+{
+    thread_local map<uint32_t, FFTPlan> plans;
+
+    FFTPlan &plan = plans[size];
+
+    if (plan.size != size)
+    {
+        plan.Init(size);
+    }
+
+    return plan;
+}
+
+/**
+ * FFT Compute an FFT of any size input, with a cached plan for the input's size.
+ * Radix-2 runs on the interleaved values directly; the other kernels split them into
+ * real and imaginary arrays first.
+ *
+ * @param waveform Waveform to compute FFT for [in].
+ * @param fft      Result of FFT. Assumed empty on input [out].
+ * @param kernel   Butterfly scheme to use [in].
+ */
+
+void FFT(vector<complex<double>> &waveform, vector<complex<double>> &fft, FFTKernel kernel)
+{
+    assert(fft.size() == 0);
+
+    const FFTPlan &plan = GetFFTPlan((uint32_t)waveform.size());
+    fft = waveform;
+
+    if (kernel == FFT_RADIX2)
+    {
+        plan.Execute(fft.data());
+        return;
+    }
+
+    vector<double> re(fft.size());
+    vector<double> im(fft.size());
+
+    for (size_t i = 0; i < fft.size(); i++)
+    {
+        re[i] = fft[i].real();
+        im[i] = fft[i].imag();
+    }
+
+    plan.Execute(re.data(), im.data(), kernel);
+
+    for (size_t i = 0; i < fft.size(); i++)
+    {
+        fft[i] = complex<double>(re[i], im[i]);
+    }
+}
+
+/**
+ * FFTPlan::ExecuteInverse - Inverse FFT in place on split arrays, scaled by 1 / size so
+ * it undoes Execute. The inverse DFT of x is the conjugate of the forward DFT of x's
+ * conjugate, so this is the forward kernel between two sign flips.
+ *
+ * @param pRe    Real parts of the spectrum, replaced with the signal's. Must hold size values [in/out].
+ * @param pIm    Imaginary parts, likewise [in/out].
+ * @param kernel Butterfly scheme to use [in].
+ */
+
+void FFTPlan::ExecuteInverse(double* pRe, double* pIm, FFTKernel kernel) const
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        pIm[i] = -pIm[i];
+    }
+
+    Execute(pRe, pIm, kernel);
+
+    double scale = 1.0 / (double)size;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        pRe[i] *= scale;
+        pIm[i] *= -scale;
+    }
+}
+
+/**
+ * InverseFFT Compute the inverse of FFT, scaled so a round trip returns the input.
+ *
+ * @param fft      Spectrum to invert [in].
+ * @param waveform Resulting waveform. Assumed empty on input [out].
+ * @param kernel   Butterfly scheme to use [in].
+ */
+
+void InverseFFT(vector<complex<double>> &fft, vector<complex<double>> &waveform, FFTKernel kernel)
+{
+    assert(waveform.size() == 0);
+
+    const FFTPlan &plan = GetFFTPlan((uint32_t)fft.size());
+
+    vector<double> re(fft.size());
+    vector<double> im(fft.size());
+
+    for (size_t i = 0; i < fft.size(); i++)
+    {
+        re[i] = fft[i].real();
+        im[i] = fft[i].imag();
+    }
+
+    plan.ExecuteInverse(re.data(), im.data(), kernel);
+    waveform.resize(fft.size());
+
+    for (size_t i = 0; i < fft.size(); i++)
+    {
+        waveform[i] = complex<double>(re[i], im[i]);
+    }
+}
+
+/**
+ * RealFFTPlan::Init - Build the half size complex plan and the twiddles w_N^k, k <= N / 4,
+ * that merge the even and odd sample transforms.
+ *
+ * @param sizeIn Number of real samples. Must be even, at least 2 [in].
+ */
+
+void RealFFTPlan::Init(uint32_t sizeIn)
+{
+    assert(sizeIn >= 2 && sizeIn % 2 == 0);
+
+    size = sizeIn;
+    halfPlan.Init(size / 2);
+
+    uint32_t quarter = size / 4;
+
+    twRe.resize(quarter + 1);
+    twIm.resize(quarter + 1);
+
+    for (uint32_t k = 0; k <= quarter; k++)
+    {
+        double angle    = -twoPi * (double)k / (double)size;
+        twRe[k]         = cos(angle);
+        twIm[k]         = sin(angle);
+    }
+}
+
+/**
+ * RealFFTPlan::Execute - Forward FFT of real samples. With z_m = x_2m + i x_2m+1 and
+ * Z its M = N / 2 point transform, the transforms of the even and odd samples are
+ *
+ *     E_k = (Z_k + conj(Z_M-k)) / 2,     O_k = -i (Z_k - conj(Z_M-k)) / 2
+ *
+ * and X_k = E_k + w_N^k O_k. Both are spectra of real sequences, so the same pass also
+ * gives X_M-k = conj(E_k - w_N^k O_k), and bins k and M - k are done together in place.
+ *
+ * @param pSamples N real samples [in].
+ * @param pRe      Real parts of bins 0 to N / 2. Must hold N / 2 + 1 values [out].
+ * @param pIm      Imaginary parts, likewise [out].
+ * @param kernel   Butterfly scheme for the half size transform [in].
+ */
+
+void RealFFTPlan::Execute(const double* pSamples, double* pRe, double* pIm, FFTKernel kernel) const
+{
+    uint32_t half = size / 2;
+
+    for (uint32_t m = 0; m < half; m++)
+    {
+        pRe[m] = pSamples[2 * m];
+        pIm[m] = pSamples[2 * m + 1];
+    }
+
+    halfPlan.Execute(pRe, pIm, kernel);
+
+    double z0r = pRe[0];
+    double z0i = pIm[0];
+
+    pRe[0]      = z0r + z0i;
+    pIm[0]      = 0.0;
+    pRe[half]   = z0r - z0i;
+    pIm[half]   = 0.0;
+
+    for (uint32_t k = 1; k <= half / 2; k++)
+    {
+        uint32_t j = half - k;
+
+        double evenR   = 0.5 * (pRe[k] + pRe[j]);
+        double evenI   = 0.5 * (pIm[k] - pIm[j]);
+        double oddR    = 0.5 * (pIm[k] + pIm[j]);
+        double oddI    = -0.5 * (pRe[k] - pRe[j]);
+
+        double tr = twRe[k] * oddR - twIm[k] * oddI;
+        double ti = twRe[k] * oddI + twIm[k] * oddR;
+
+        pRe[k] = evenR + tr;
+        pIm[k] = evenI + ti;
+        pRe[j] = evenR - tr;
+        pIm[j] = ti - evenI;
+    }
+}
+
+/**
+ * RealFFTPlan::ExecuteInverse - Inverse of Execute. Split bins k and M - k back into
+ * E_k and w_N^k O_k, rebuild Z_k = E_k + i O_k and Z_M-k, run the half size inverse, and
+ * unpack the real and imaginary parts into even and odd samples.
+ *
+ * @param pRe      Real parts of bins 0 to N / 2. Used as scratch, so clobbered [in/out].
+ * @param pIm      Imaginary parts, likewise. The imaginary parts of bins 0 and N / 2
+ *                 are taken to be zero, as they are for any real signal [in/out].
+ * @param pSamples N real samples [out].
+ * @param kernel   Butterfly scheme for the half size transform [in].
+ */
+
+void RealFFTPlan::ExecuteInverse(double* pRe, double* pIm, double* pSamples, FFTKernel kernel) const
+{
+    uint32_t half = size / 2;
+
+    double x0 = pRe[0];
+    double xM = pRe[half];
+
+    pRe[0] = 0.5 * (x0 + xM);
+    pIm[0] = 0.5 * (x0 - xM);
+
+    for (uint32_t k = 1; k <= half / 2; k++)
+    {
+        uint32_t j = half - k;
+
+        double evenR   = 0.5 * (pRe[k] + pRe[j]);
+        double evenI   = 0.5 * (pIm[k] - pIm[j]);
+        double dr      = 0.5 * (pRe[k] - pRe[j]);
+        double di      = 0.5 * (pIm[k] + pIm[j]);
+
+        double oddR    = twRe[k] * dr + twIm[k] * di;
+        double oddI    = twRe[k] * di - twIm[k] * dr;
+
+        pRe[k] = evenR - oddI;
+        pIm[k] = evenI + oddR;
+        pRe[j] = evenR + oddI;
+        pIm[j] = oddR - evenI;
+    }
+
+    halfPlan.ExecuteInverse(pRe, pIm, kernel);
+
+    for (uint32_t m = 0; m < half; m++)
+    {
+        pSamples[2 * m]     = pRe[m];
+        pSamples[2 * m + 1] = pIm[m];
+    }
+}
+
+/**
+ * GetRealFFTPlan - Get a real FFT plan for a size, building it on first use and caching
+ * it per thread, like GetFFTPlan.
+ *
+ * @param size Number of real samples. Must be even, at least 2 [in].
+ *
+ * @return Plan for that size. Stays valid for the life of the calling thread.
+ */
+
+const RealFFTPlan& GetRealFFTPlan(uint32_t size)
+{
+    thread_local map<uint32_t, RealFFTPlan> plans;
+
+    RealFFTPlan &plan = plans[size];
+
+    if (plan.size != size)
+    {
+        plan.Init(size);
+    }
+
+    return plan;
+}
+
+/**
+ * RealFFT Compute the FFT of real samples. Only bins 0 to N / 2 are returned; bin N - k
+ * is the complex conjugate of bin k.
+ *
+ * @param samples  Real samples. Size must be even, at least 2 [in].
+ * @param spectrum Bins 0 to N / 2. Assumed empty on input [out].
+ * @param kernel   Butterfly scheme to use [in].
+ */
+
+void RealFFT(const vector<double> &samples, vector<complex<double>> &spectrum, FFTKernel kernel)
+{
+    assert(spectrum.size() == 0);
+
+    const RealFFTPlan &plan = GetRealFFTPlan((uint32_t)samples.size());
+    size_t numBins          = samples.size() / 2 + 1;
+
+    vector<double> re(numBins);
+    vector<double> im(numBins);
+
+    plan.Execute(samples.data(), re.data(), im.data(), kernel);
+    spectrum.resize(numBins);
+
+    for (size_t i = 0; i < numBins; i++)
+    {
+        spectrum[i] = complex<double>(re[i], im[i]);
+    }
+}
+
+/**
+ * InverseRealFFT Compute the real samples with a given half spectrum, the inverse of
+ * RealFFT.
+ *
+ * @param spectrum Bins 0 to N / 2, for an even N of at least 2 [in].
+ * @param samples  N real samples. Assumed empty on input [out].
+ * @param kernel   Butterfly scheme to use [in].
+ */
+
+void InverseRealFFT(const vector<complex<double>> &spectrum, vector<double> &samples, FFTKernel kernel)
+{
+    assert(samples.size() == 0 && spectrum.size() >= 2);
+
+    uint32_t size           = 2 * (uint32_t)(spectrum.size() - 1);
+    const RealFFTPlan &plan = GetRealFFTPlan(size);
+
+    vector<double> re(spectrum.size());
+    vector<double> im(spectrum.size());
+
+    for (size_t i = 0; i < spectrum.size(); i++)
+    {
+        re[i] = spectrum[i].real();
+        im[i] = spectrum[i].imag();
+    }
+
+    samples.resize(size);
+    plan.ExecuteInverse(re.data(), im.data(), samples.data(), kernel);
+}
+
+/**
+ * TestDFT Test routine for FFT. Compute both a direct DFT and FFT of simple waveform.
+ * Report computation times and compare outputs of both methods.
+ */
+
+void TestDFT()
+{
+    // Generate time domain and test waveform.
+
+    vector<SinusoidsParams> waves;
+    waves.push_back({ 1.0, 4.0, 0.0 });
+
+    const uint32_t numSamples = 1024;
+    const double dt = twoPi / (double)numSamples;
+
+    vector<double> domain;
+
+    for (uint32_t i = 0; i < numSamples; i++)
+    {
+        domain.push_back(i * dt);
+    }
+
+    vector<complex<double>> samples;
+    GetWaveform(waves, domain, samples);
+
+    // Time the DFT
+
+    vector<complex<double>> dft;
+
+    BenchStats dftStats = runBenchmark("DFT", [&]()
+    {
+        dft.clear();
+        DFTDirect(samples, dft);
+    });
+
+    printBenchStats(dftStats);
+
+    vector<double> dftMagnitudes(dft.size(), 0.0);
+
+    for (uint32_t i = 0; i < dft.size(); i++)
+    {
+        dftMagnitudes[i] = sqrt(dft[i].real() * dft[i].real() + dft[i].imag() * dft[i].imag());
+    }
+
+    // Time the FFT
+
+    vector<complex<double>> fft;
+
+    BenchStats fftStats = runBenchmark("FFT", [&]()
+    {
+        fft.clear();
+        FFT(samples, fft);
+    });
+
+    printBenchStats(fftStats);
+
+    // Time in-place transforms with one plan per size, the way a caller doing many FFTs
+    // of the same size would, for each kernel on split arrays. Copying the input back in
+    // reuses the same storage, so nothing allocates.
+
+    const char* kernelNames[] = { "radix-2", "radix-4", "split-radix" };
+
+    for (uint32_t logSize = 10; logSize <= 20; logSize += 5)
+    {
+        uint32_t size       = 1 << logSize;
+        const FFTPlan &plan = GetFFTPlan(size);
+
+        vector<double> inRe(size);
+        vector<double> inIm(size);
+        vector<double> re(size);
+        vector<double> im(size);
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            inRe[i] = samples[i % numSamples].real();
+            inIm[i] = samples[i % numSamples].imag();
+        }
+
+        for (uint32_t kernel = FFT_RADIX2; kernel <= FFT_SPLIT_RADIX; kernel++)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "2^%u %s", logSize, kernelNames[kernel]);
+
+            BenchStats planStats = runBenchmark(name, [&]()
+            {
+                copy(inRe.begin(), inRe.end(), re.begin());
+                copy(inIm.begin(), inIm.end(), im.begin());
+                plan.Execute(re.data(), im.data(), (FFTKernel)kernel);
+            });
+
+            printBenchStats(planStats);
+        }
+    }
+
+    vector<double> fftMagnitudes(fft.size(), 0.0);
+
+    for (uint32_t i = 0; i < fft.size(); i++)
+    {
+        fftMagnitudes[i] = sqrt(fft[i].real() * fft[i].real() + fft[i].imag() * fft[i].imag());
+    }
+
+    // Compare results
+
+    for (uint32_t i = 0; i < numSamples; i++)
+    {
+        printf("DFT[%d] = %g, FFT[%d] = %g\n", i, dftMagnitudes[i], i, fftMagnitudes[i]);
+    }
+
+    // Real signals. Time the real FFT against a complex FFT of the same samples. Then
+    // check it against the complex FFT, which the direct DFT checks below, on random
+    // input, and check both inverses round trip.
+
+    const uint32_t realSize = 1 << 20;
+
+    vector<double> realDomain(realSize);
+    vector<double> realSamples;
+
+    for (uint32_t i = 0; i < realSize; i++)
+    {
+        realDomain[i] = i * twoPi / (double)realSize;
+    }
+
+    GetRealWaveform(waves, realDomain, realSamples);
+
+    const RealFFTPlan &realPlan     = GetRealFFTPlan(realSize);
+    const FFTPlan &complexPlan      = GetFFTPlan(realSize);
+
+    vector<double> re(realSize);
+    vector<double> im(realSize);
+
+    BenchStats realStats = runBenchmark("2^20 real", [&]()
+    {
+        realPlan.Execute(realSamples.data(), re.data(), im.data());
+    });
+
+    printBenchStats(realStats);
+
+    BenchStats complexStats = runBenchmark("2^20 complex", [&]()
+    {
+        copy(realSamples.begin(), realSamples.end(), re.begin());
+        fill(im.begin(), im.end(), 0.0);
+        complexPlan.Execute(re.data(), im.data(), FFT_SPLIT_RADIX);
+    });
+
+    printBenchStats(complexStats);
+
+    double realError    = 0.0;
+    double inverseError = 0.0;
+
+    for (uint32_t n = 2; n <= (1 << 16); n <<= 1)
+    {
+        vector<double> input(n);
+
+        for (auto& val : input)
+        {
+            val = (double)rand() / RAND_MAX - 0.5;
+        }
+
+        vector<complex<double>> complexInput(input.begin(), input.end());
+        vector<complex<double>> spectrum;
+        vector<complex<double>> fullSpectrum;
+        vector<complex<double>> complexOutput;
+        vector<double> output;
+
+        RealFFT(input, spectrum);
+        FFT(complexInput, fullSpectrum);
+
+        for (uint32_t i = 0; i <= n / 2; i++)
+        {
+            realError = max(realError, abs(spectrum[i] - fullSpectrum[i]));
+        }
+
+        InverseRealFFT(spectrum, output);
+        InverseFFT(fullSpectrum, complexOutput);
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            inverseError = max(inverseError, fabs(output[i] - input[i]));
+            inverseError = max(inverseError, abs(complexOutput[i] - complexInput[i]));
+        }
+    }
+
+    printf("Max |RealFFT - FFT| over sizes 2 to 65536: %g\n", realError);
+    printf("Max round trip error over sizes 2 to 65536: %g\n", inverseError);
+
+    // Check every kernel against the direct DFT at every power-of-two size up to 4096,
+    // down to the trivial size 1, on random input so every bin matters. Split-radix
+    // only recurses past 1024 points, so the last sizes are the ones that exercise it.
+
+    const uint32_t maxCheckSize = 4096;
+    vector<complex<double>> noise(maxCheckSize);
+    double maxError[3] = { 0.0, 0.0, 0.0 };
+
+    for (auto& val : noise)
+    {
+        val = complex<double>((double)rand() / RAND_MAX - 0.5, (double)rand() / RAND_MAX - 0.5);
+    }
+
+    for (uint32_t n = 1; n <= maxCheckSize; n <<= 1)
+    {
+        vector<complex<double>> input(noise.begin(), noise.begin() + n);
+        vector<complex<double>> direct;
+
+        DFTDirect(input, direct);
+
+        for (uint32_t kernel = FFT_RADIX2; kernel <= FFT_SPLIT_RADIX; kernel++)
+        {
+            vector<complex<double>> fast;
+            FFT(input, fast, (FFTKernel)kernel);
+
+            for (uint32_t i = 0; i < n; i++)
+            {
+                maxError[kernel] = max(maxError[kernel], abs(direct[i] - fast[i]));
+            }
+        }
+    }
+
+    for (uint32_t kernel = FFT_RADIX2; kernel <= FFT_SPLIT_RADIX; kernel++)
+    {
+        printf("Max |DFT - FFT| %s, sizes 1 to %d: %g\n", kernelNames[kernel], maxCheckSize, maxError[kernel]);
+    }
+
+    // Sizes that aren't powers of two: every one up to 256, which covers both mixed radix
+    // and Bluestein, and a few bigger ones, 1000 = 2^3 5^3, 1001 = 7 11 13, 2310 =
+    // 2 3 5 7 11 and the prime 4093. Check each kernel, the round trip, and the real FFT
+    // at even sizes.
+
+    vector<uint32_t> otherSizes = { 1000, 1001, 2310, 4093 };
+
+    for (uint32_t n = 3; n <= 256; n++)
+    {
+        if (!OnetBitSet(n))
+        {
+            otherSizes.push_back(n);
+        }
+    }
+
+    double mixedError       = 0.0;
+    double bluesteinError   = 0.0;
+    double otherInverse     = 0.0;
+    double otherReal        = 0.0;
+
+    for (uint32_t n : otherSizes)
+    {
+        vector<complex<double>> input(noise.begin(), noise.begin() + n);
+        vector<complex<double>> direct;
+
+        DFTDirect(input, direct);
+
+        double &error = GetFFTPlan(n).convPlan ? bluesteinError : mixedError;
+
+        for (uint32_t kernel = FFT_RADIX2; kernel <= FFT_SPLIT_RADIX; kernel++)
+        {
+            vector<complex<double>> fast;
+            FFT(input, fast, (FFTKernel)kernel);
+
+            for (uint32_t i = 0; i < n; i++)
+            {
+                error = max(error, abs(direct[i] - fast[i]));
+            }
+        }
+
+        vector<complex<double>> output;
+        InverseFFT(direct, output);
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            otherInverse = max(otherInverse, abs(output[i] - input[i]));
+        }
+
+        if (n % 2 == 0)
+        {
+            vector<double> realInput(n);
+            vector<complex<double>> complexInput(n);
+            vector<complex<double>> spectrum;
+            vector<complex<double>> fullSpectrum;
+
+            for (uint32_t i = 0; i < n; i++)
+            {
+                realInput[i]    = input[i].real();
+                complexInput[i] = input[i].real();
+            }
+
+            RealFFT(realInput, spectrum);
+            FFT(complexInput, fullSpectrum);
+
+            for (uint32_t i = 0; i <= n / 2; i++)
+            {
+                otherReal = max(otherReal, abs(spectrum[i] - fullSpectrum[i]));
+            }
+        }
+    }
+
+    printf("Max |DFT - FFT| mixed radix sizes: %g\n", mixedError);
+    printf("Max |DFT - FFT| Bluestein sizes: %g\n", bluesteinError);
+    printf("Max round trip error, other sizes: %g\n", otherInverse);
+    printf("Max |RealFFT - FFT|, other even sizes: %g\n", otherReal);
+
+    // Time arbitrary sizes against the 2^20 transforms above: 10^6 = 2^6 5^6 with mixed
+    // radix passes, and the prime 1000003 with Bluestein.
+
+    const uint32_t timeSizes[] = { 1000000, 1000003 };
+
+    for (uint32_t size : timeSizes)
+    {
+        const FFTPlan &plan = GetFFTPlan(size);
+
+        vector<double> inRe(size);
+        vector<double> inIm(size);
+        vector<double> re(size);
+        vector<double> im(size);
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            inRe[i] = samples[i % numSamples].real();
+            inIm[i] = samples[i % numSamples].imag();
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%u %s", size, plan.convPlan ? "Bluestein" : "mixed radix");
+
+        BenchStats otherStats = runBenchmark(name, [&]()
+        {
+            copy(inRe.begin(), inRe.end(), re.begin());
+            copy(inIm.begin(), inIm.end(), im.begin());
+            plan.Execute(re.data(), im.data(), FFT_SPLIT_RADIX);
+        });
+
+        printBenchStats(otherStats);
+    }
 }
\ No newline at end of file
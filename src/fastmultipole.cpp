@@ -79,13 +79,10 @@ void TestMultipole()
         particles[i] = p;
     }
 
-    long long t1 = GetMilliseconds();
+    Timer timer;
+    timer.Start();
     NBodyDirect(particles, forces);
-    long long t2 = GetMilliseconds();
-
-    double elapsedTime = (double)(t2 - t1);
+    double elapsedTime = timer.ElapsedMs();
 
     printf("NBody Direct Elapsed Time: %gms\n", elapsedTime);
-
-    __debugbreak();
 }
\ No newline at end of file
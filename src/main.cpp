@@ -1,70 +1,761 @@
 #include "commoninclude.h"
 #include "problems.h"
+#include "threadpool.h"
 
-typedef void (*pfnTest)(void);
-
-map<string, pfnTest> tests =
-{
-    { "PE66", PE66 },
-    { "PE68", PE68 },
-    { "PE75", PE75 },
-    { "PE77", PE77 },
-    { "PE78", PE78 },
-    { "PE83", PE83 },
-    { "PE91", PE91 },
-    { "PE95", PE95 },
-    { "PE96", PE96 },
-    { "PE100", PE100 },
-    { "PE104", PE104 },
-    { "PE108", PE108 },
-    { "PE113", PE113 },
-    { "PE116", PE116 },
-    { "PE119", PE119 },
-    { "PE120", PE120 },
-    { "PE123", PE123 },
-    { "PE124", PE124 },
-    { "PE125", PE125 },
-    { "PE173", PE173 },
-    { "PE179", PE179 },
-    { "PE187", PE187 },
-    { "PE203", PE203 },
-    { "PE204", PE204 },
-    { "PE293", PE293 },
-    { "PE313", PE313 },
-    { "PE329", PE329 },
-    { "PE321", PE321 },
-    { "PE340", PE340 },
-    { "PE348", PE348 },
-    { "PE351", PE351 },
-    { "PE358", PE358 },
-    { "PE359", PE359 },
-    { "PE401", PE401 },
-    { "PE425", PE425 },
-    { "PE479", PE479 },
-    { "PE512", PE512 },
-    { "PE516", PE516 },
-    { "PE518", PE518 },
-    { "PE531", PE531 },
-    { "PE571", PE571 },
-    { "PE577", PE577 },
-    { "PE581", PE581 },
-    { "PE587", PE587 },
-    { "PE601", PE601 },
-    { "PE607", PE607 },
-    { "PE622", PE622 },
-    { "SHA256", TestSHA256 }
+/**
+ * Test - An entry in the tests table. Problems that take a parameter struct keep their
+ * own copy of it, and bind hands its fields to a ParamSet so they can be changed before
+ * run. bind is empty for tests without parameters.
+ */
+
+struct Test
+{
+    function<void()> run;
+    function<void(ParamSet&)> bind;
 };
 
+Test MakeTest(void (*pfnTest)())
+{
+    return { pfnTest, nullptr };
+}
+
+template<typename P>
+Test MakeTest(void (*pfnTest)(const P&))
+{
+    shared_ptr<P> pParams = make_shared<P>();
+
+    return
+    {
+        [=]() { pfnTest(*pParams); },
+        [=](ParamSet &set) { pParams->Bind(set); }
+    };
+}
+
+map<string, Test> tests =
+{
+    { "PE66", MakeTest(PE66) },
+    { "PE68", MakeTest(PE68) },
+    { "PE75", MakeTest(PE75) },
+    { "PE77", MakeTest(PE77) },
+    { "PE78", MakeTest(PE78) },
+    { "PE83", MakeTest(PE83) },
+    { "PE91", MakeTest(PE91) },
+    { "PE95", MakeTest(PE95) },
+    { "PE96", MakeTest(PE96) },
+    { "PE100", MakeTest(PE100) },
+    { "PE104", MakeTest(PE104) },
+    { "PE108", MakeTest(PE108) },
+    { "PE113", MakeTest(PE113) },
+    { "PE116", MakeTest(PE116) },
+    { "PE119", MakeTest(PE119) },
+    { "PE120", MakeTest(PE120) },
+    { "PE123", MakeTest(PE123) },
+    { "PE124", MakeTest(PE124) },
+    { "PE125", MakeTest(PE125) },
+    { "PE173", MakeTest(PE173) },
+    { "PE179", MakeTest(PE179) },
+    { "PE187", MakeTest(PE187) },
+    { "PE203", MakeTest(PE203) },
+    { "PE204", MakeTest(PE204) },
+    { "PE293", MakeTest(PE293) },
+    { "PE313", MakeTest(PE313) },
+    { "PE329", MakeTest(PE329) },
+    { "PE321", MakeTest(PE321) },
+    { "PE340", MakeTest(PE340) },
+    { "PE348", MakeTest(PE348) },
+    { "PE351", MakeTest(PE351) },
+    { "PE358", MakeTest(PE358) },
+    { "PE359", MakeTest(PE359) },
+    { "PE401", MakeTest(PE401) },
+    { "PE425", MakeTest(PE425) },
+    { "PE479", MakeTest(PE479) },
+    { "PE512", MakeTest(PE512) },
+    { "PE516", MakeTest(PE516) },
+    { "PE518", MakeTest(PE518) },
+    { "PE531", MakeTest(PE531) },
+    { "PE571", MakeTest(PE571) },
+    { "PE577", MakeTest(PE577) },
+    { "PE581", MakeTest(PE581) },
+    { "PE587", MakeTest(PE587) },
+    { "PE601", MakeTest(PE601) },
+    { "PE607", MakeTest(PE607) },
+    { "PE622", MakeTest(PE622) },
+    { "SHA256", MakeTest(TestSHA256) },
+    { "DFT", MakeTest(TestDFT) },
+    { "NTT", MakeTest(TestNTT) },
+    { "Factor64", MakeTest(TestFactor64) },
+    { "Gcd", MakeTest(TestGcd) },
+    { "ModArith", MakeTest(TestModArith) },
+    { "CRT", MakeTest(TestCRT) },
+    { "QuickSort", MakeTest(TestQuickSort) },
+    { "Multipole", MakeTest(TestMultipole) }
+};
+
+/**
+ * Rough peak memory of the tests that need a lot of it, in MB, from --bench runs. Used to
+ * keep parallel runs inside the memory budget. Anything not listed is assumed to fit in
+ * defaultTestMemoryMb.
+ */
+
+map<string, uint64_t> testMemoryMb =
+{
+    { "PE75", 90 },
+    { "PE78", 350 },
+    { "PE95", 25 },
+    { "PE179", 50 },
+    { "PE204", 125 },
+    { "PE293", 410 },
+    { "PE351", 400 },
+    { "PE425", 130 },
+    { "PE516", 95 },
+    { "PE518", 60 },
+    { "PE581", 560 },
+    { "DFT", 320 },
+    { "NTT", 330 }
+};
+
+static const uint64_t defaultTestMemoryMb = 64;
+
 void DisplayTestsAndExit()
 {
-    printf("Usage: ProgrammingProblems.exe <test name>");
+    printf("Usage: ProgrammingProblems.exe <test name> [--param=value ...] [--trials=N] [--warmup=N] [--counters]\n");
+    printf("       ProgrammingProblems.exe <test name> --sweep=param,from,to[,factor] [--param=value ...]\n");
+    printf("       ProgrammingProblems.exe --bench [pattern ...] [--trials=N] [--warmup=N] [--counters]\n");
+    printf("           [--expected=file] [--record] [--json=file] [--csv=file]\n");
+    printf("           [--jobs=N] [--mem-budget=MB]\n\n");
+    printf("With any of the options, time the test with the benchmark harness instead of\n");
+    printf("running it once. --counters adds cycle and cache miss counts where available.\n\n");
+    printf("Tests listed with parameters take new values for them, e.g. PE512 --max=1e9.\n");
+    printf("--sweep times the test with one parameter stepped geometrically from one value\n");
+    printf("to another (by a factor of 2 unless given), then fits the run times to\n");
+    printf("c * param^k to estimate the complexity exponent k.\n\n");
+    printf("--bench runs every test matching any of the patterns (* and ? wildcards, all\n");
+    printf("tests if none given) and checks each answer, the last line it prints, against\n");
+    printf("the expected answers file (answers.txt by default). --record writes the answers\n");
+    printf("from this run back to that file. --json and --csv save the results.\n\n");
+    printf("Each test runs in its own process. --jobs runs up to N of them at once (0 or above\n");
+    printf("the thread pool's size for one per pool thread), without starting a test that\n");
+    printf("would push the estimated total memory past --mem-budget (default three quarters\n");
+    printf("of physical memory).\n\n");
     printf("Available Tests:\n\n");
 
-    for (auto& test : tests) printf("%s\n", test.first.c_str());
+    for (auto& test : tests)
+    {
+        ParamSet params;
+
+        if (test.second.bind)
+        {
+            test.second.bind(params);
+        }
+
+        if (params.params.empty())
+        {
+            printf("%s\n", test.first.c_str());
+        }
+        else
+        {
+            printf("%-12s %s\n", test.first.c_str(), params.ToString().c_str());
+        }
+    }
 
     exit(0);
 }
 
+/**
+ * BenchSuiteOptions - Extra settings for --bench runs across many tests. parallel is
+ * false to run tests one after another, each still in its own child process.
+ */
+
+struct BenchSuiteOptions
+{
+    vector<string> patterns;
+    string expectedFile;
+    string jsonFile;
+    string csvFile;
+    bool record;
+
+    string exePath;
+    bool parallel;
+    uint32_t jobs;
+    uint64_t memBudgetMb;
+
+    BenchSuiteOptions() : expectedFile("answers.txt"), record(false), parallel(false), jobs(0), memBudgetMb(0) {};
+};
+
+/**
+ * ParseBenchOptions - Pull benchmark options out of the command line arguments.
+ *
+ * @param args    Arguments after the test name, or after --bench.
+ * @param options (out) Parsed options. Defaults for anything not given.
+ * @param pSuite  (out) Suite options and test patterns for --bench. Null when running a
+ * single test, in which case they're rejected.
+ *
+ * @return True if any benchmark option was given, false to just run the test.
+ */
+
+bool ParseBenchOptions(const vector<string> &args, BenchOptions &options, BenchSuiteOptions *pSuite)
+{
+    bool bench = false;
+
+    for (auto& arg : args)
+    {
+        if (arg.compare(0, 9, "--trials=") == 0)
+        {
+            options.trials = (uint32_t)strtoul(arg.c_str() + 9, nullptr, 10);
+            bench = true;
+        }
+        else if (arg.compare(0, 9, "--warmup=") == 0)
+        {
+            options.warmup = (uint32_t)strtoul(arg.c_str() + 9, nullptr, 10);
+            bench = true;
+        }
+        else if (arg == "--counters")
+        {
+            options.counters = true;
+            bench = true;
+        }
+        else if (pSuite && arg.compare(0, 11, "--expected=") == 0)
+        {
+            pSuite->expectedFile = arg.substr(11);
+        }
+        else if (pSuite && arg == "--record")
+        {
+            pSuite->record = true;
+        }
+        else if (pSuite && arg.compare(0, 7, "--json=") == 0)
+        {
+            pSuite->jsonFile = arg.substr(7);
+        }
+        else if (pSuite && arg.compare(0, 6, "--csv=") == 0)
+        {
+            pSuite->csvFile = arg.substr(6);
+        }
+        else if (pSuite && arg.compare(0, 7, "--jobs=") == 0)
+        {
+            pSuite->jobs        = (uint32_t)strtoul(arg.c_str() + 7, nullptr, 10);
+            pSuite->parallel    = true;
+        }
+        else if (pSuite && arg.compare(0, 13, "--mem-budget=") == 0)
+        {
+            pSuite->memBudgetMb = strtoull(arg.c_str() + 13, nullptr, 10);
+        }
+        else if (pSuite && arg.compare(0, 2, "--") != 0)
+        {
+            pSuite->patterns.push_back(arg);
+        }
+        else
+        {
+            DisplayTestsAndExit();
+        }
+    }
+
+    return bench;
+}
+
+/**
+ * ParseParams - Apply the "--name=value" arguments that name one of a test's parameters.
+ *
+ * @param params Parameters of the test. Set in place.
+ * @param args   Arguments after the test name.
+ * @param rest   (out) Arguments that aren't parameters, in order.
+ *
+ * @return False if a parameter was given a value that doesn't fit it.
+ */
+
+bool ParseParams(ParamSet &params, const vector<string> &args, vector<string> &rest)
+{
+    for (auto& arg : args)
+    {
+        bool bValid = true;
+
+        if (!params.ParseArg(arg, bValid))
+        {
+            rest.push_back(arg);
+        }
+        else if (!bValid)
+        {
+            printf("Invalid value in %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Child processes started by RunTestInChild run the test normally, then print one last
+ * line starting with childResultTag and holding their stats.
+ */
+
+static const char* childResultTag = "@@bench";
+
+/**
+ * RunChild - Body of a child process started by RunTestInChild. Run the test, letting
+ * its output through, then report stats on a final tagged line.
+ *
+ * @param name    Test name.
+ * @param options Trial and warm-up counts.
+ *
+ * @return Process exit code.
+ */
+
+int RunChild(const string &name, const BenchOptions &options)
+{
+    if (tests.count(name) == 0)
+    {
+        return 1;
+    }
+
+    BenchStats stats = runBenchmark(name, tests[name].run, options);
+
+    printf("\n%s %u %.6f %.6f %.6f %.6f %llu %llu %d %llu %llu\n", childResultTag, stats.trials,
+        stats.minMs, stats.medianMs, stats.p95Ms, stats.meanMs,
+        (unsigned long long)stats.medianTsc, (unsigned long long)getPeakRssKb(),
+        stats.hasCounters ? 1 : 0, (unsigned long long)stats.cycles,
+        (unsigned long long)stats.cacheMisses);
+
+    return 0;
+}
+
+/**
+ * RunTestInChild - Run one test in a child copy of this program and collect its output
+ * and stats. The child's peak memory is its own, so it's exact on every OS. If the child
+ * dies without reporting, the parent's wall time stands in for its stats.
+ *
+ * @param suite   Suite options, for the executable path.
+ * @param name    Test name.
+ * @param options Trial and warm-up counts, and whether to read hardware counters.
+ *
+ * @return Timing, counters, peak memory and answer. Status is "crash" if the child
+ * failed, and left for the caller otherwise.
+ */
+
+BenchResult RunTestInChild(const BenchSuiteOptions &suite, const string &name, const BenchOptions &options)
+{
+    BenchResult result;
+    string output;
+
+    char args[128];
+    snprintf(args, sizeof(args), " --run-child %s --trials=%u --warmup=%u%s",
+        name.c_str(), options.trials, options.warmup, options.counters ? " --counters" : "");
+
+    Timer timer;
+    timer.Start();
+
+    int exitCode    = runCommand("\"" + suite.exePath + "\"" + args, output);
+    double wallMs   = timer.ElapsedMs();
+    size_t tagPos   = output.rfind(string("\n") + childResultTag + " ");
+
+    unsigned int trials;
+    unsigned long long medianTsc;
+    unsigned long long peakRssKb;
+    int hasCounters;
+    unsigned long long cycles;
+    unsigned long long cacheMisses;
+
+    result.stats.name           = name;
+    result.stats.hasCounters    = false;
+    result.stats.cycles         = 0;
+    result.stats.cacheMisses    = 0;
+
+    if (exitCode == 0 && tagPos != string::npos &&
+        sscanf(output.c_str() + tagPos + 1 + strlen(childResultTag), "%u %lf %lf %lf %lf %llu %llu %d %llu %llu",
+            &trials, &result.stats.minMs, &result.stats.medianMs, &result.stats.p95Ms,
+            &result.stats.meanMs, &medianTsc, &peakRssKb, &hasCounters, &cycles, &cacheMisses) == 10)
+    {
+        result.stats.trials         = trials;
+        result.stats.medianTsc      = medianTsc;
+        result.stats.hasCounters    = (hasCounters != 0);
+        result.stats.cycles         = cycles;
+        result.stats.cacheMisses    = cacheMisses;
+        result.peakRssKb            = peakRssKb;
+        result.answer               = lastLine(output.substr(0, tagPos));
+    }
+    else
+    {
+        result.stats.trials     = 1;
+        result.stats.minMs      = wallMs;
+        result.stats.medianMs   = wallMs;
+        result.stats.p95Ms      = wallMs;
+        result.stats.meanMs     = wallMs;
+        result.stats.medianTsc  = 0;
+        result.stats.trialMs    = { wallMs };
+        result.peakRssKb        = 0;
+        result.answer           = lastLine(output);
+        result.status           = "crash";
+    }
+
+    return result;
+}
+
+/**
+ * MemoryAdmission - Gate for starting tests in parallel. A test can start once there's a
+ * free job slot and its memory estimate fits in what's left of the budget. A test that's
+ * bigger than the whole budget still gets to run, but only on its own.
+ */
+
+struct MemoryAdmission
+{
+    mutex lock;
+    condition_variable released;
+
+    uint64_t budgetMb;
+    uint64_t usedMb;
+    uint32_t maxJobs;
+    uint32_t running;
+
+    MemoryAdmission(uint64_t budgetMbIn, uint32_t maxJobsIn) :
+        budgetMb(budgetMbIn), usedMb(0), maxJobs(maxJobsIn), running(0) {};
+
+    void Acquire(uint64_t mb)
+    {
+        unique_lock<mutex> guard(lock);
+
+        released.wait(guard, [&]()
+        {
+            return running == 0 || (running < maxJobs && usedMb + mb <= budgetMb);
+        });
+
+        usedMb += mb;
+        running++;
+    }
+
+    void Release(uint64_t mb)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            usedMb -= mb;
+            running--;
+        }
+
+        released.notify_all();
+    }
+};
+
+/**
+ * RunTestsInParallel - Run tests each in their own child process, several at once. Tests
+ * are handed to the shared thread pool biggest first, so the memory hungry ones don't
+ * end up serialized at the tail of the run, and MemoryAdmission holds each back until
+ * it fits. Each waiting test holds a pool thread, so jobs is capped at the pool's size.
+ *
+ * @param names   Tests to run.
+ * @param options Trial and warm-up counts.
+ * @param suite   Job count, memory budget and executable path.
+ * @param results (out) One result per test, in the same order as names.
+ */
+
+void RunTestsInParallel(const vector<string> &names, const BenchOptions &options, const BenchSuiteOptions &suite, vector<BenchResult> &results)
+{
+    ThreadPool &pool = GetThreadPool();
+    TaskGroup group;
+
+    uint32_t jobs       = (suite.jobs && suite.jobs < pool.NumThreads()) ? suite.jobs : pool.NumThreads();
+    uint64_t budgetMb   = suite.memBudgetMb ? suite.memBudgetMb : getPhysicalMemoryMb() / 4 * 3;
+
+    MemoryAdmission admission(budgetMb ? budgetMb : UINT64_MAX, jobs);
+    mutex printLock;
+
+    if (suite.jobs > jobs)
+    {
+        fprintf(stderr, "--jobs=%u is more than the %u pool threads, running %u at once.\n",
+            suite.jobs, jobs, jobs);
+    }
+
+    vector<uint64_t> memoryMb(names.size());
+    vector<size_t> order(names.size());
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        auto estimate   = testMemoryMb.find(names[i]);
+        memoryMb[i]     = (estimate == testMemoryMb.end()) ? defaultTestMemoryMb : estimate->second;
+        order[i]        = i;
+    }
+
+    // Workers take their newest task first, so submit smallest first to start biggest
+    // first.
+
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return memoryMb[a] < memoryMb[b]; });
+
+    results.resize(names.size());
+
+    for (size_t i : order)
+    {
+        pool.Submit([&, i]()
+        {
+            admission.Acquire(memoryMb[i]);
+
+            {
+                lock_guard<mutex> guard(printLock);
+                fprintf(stderr, "Running %s...\n", names[i].c_str());
+            }
+
+            results[i] = RunTestInChild(suite, names[i], options);
+            admission.Release(memoryMb[i]);
+        }, &group);
+    }
+
+    pool.Wait(group);
+}
+
+/**
+ * RunBenchSuite - Run every test matching the patterns under the benchmark harness,
+ * each in its own child process, one after another or several at once. A child's peak
+ * memory is its own, so it isn't inflated by tests that ran before it, and a test that
+ * crashes doesn't take the rest of the run with it. Each test's output is captured
+ * rather than printed, and its last line is taken as its answer and checked against the
+ * expected answers.
+ *
+ * @param options Trial and warm-up counts.
+ * @param suite   Which tests to run, how, and where to read and write results.
+ *
+ * @return Number of tests whose answer didn't match the expected one, or that crashed.
+ */
+
+uint32_t RunBenchSuite(const BenchOptions &options, BenchSuiteOptions &suite)
+{
+    if (suite.patterns.empty())
+    {
+        suite.patterns.push_back("*");
+    }
+
+    map<string, string> expected;
+    readExpectedAnswers(suite.expectedFile.c_str(), expected);
+
+    vector<string> names;
+
+    for (auto& test : tests)
+    {
+        bool matched = false;
+
+        for (auto& pattern : suite.patterns)
+        {
+            matched = matched || globMatch(pattern.c_str(), test.first.c_str());
+        }
+
+        if (matched)
+        {
+            names.push_back(test.first);
+        }
+    }
+
+    vector<BenchResult> results;
+
+    if (suite.parallel)
+    {
+        RunTestsInParallel(names, options, suite, results);
+    }
+    else
+    {
+        for (auto& name : names)
+        {
+            fprintf(stderr, "Running %s...\n", name.c_str());
+            results.push_back(RunTestInChild(suite, name, options));
+        }
+    }
+
+    uint32_t numFailed = 0;
+
+    for (auto& result : results)
+    {
+        auto expectedAnswer = expected.find(result.stats.name);
+
+        if (expectedAnswer != expected.end())
+        {
+            result.expected = expectedAnswer->second;
+        }
+
+        if (result.status.empty())
+        {
+            if (expectedAnswer == expected.end())
+            {
+                result.status = "unknown";
+            }
+            else
+            {
+                result.status = (result.answer == result.expected) ? "pass" : "fail";
+            }
+        }
+
+        if (result.status == "fail" || result.status == "crash")
+        {
+            numFailed++;
+        }
+    }
+
+    printf("%-12s %10s %10s %10s %10s  %-7s %s\n", "test", "min ms", "median ms", "p95 ms", "peak KB", "status", "answer");
+
+    for (auto& result : results)
+    {
+        printf("%-12s %10.3f %10.3f %10.3f %10llu  %-7s %s", result.stats.name.c_str(),
+            result.stats.minMs, result.stats.medianMs, result.stats.p95Ms,
+            (unsigned long long)result.peakRssKb, result.status.c_str(), result.answer.c_str());
+
+        if (result.status == "fail")
+        {
+            printf(" (expected %s)", result.expected.c_str());
+        }
+
+        printf("\n");
+    }
+
+    printf("\n%u tests, %u failed\n", (uint32_t)results.size(), numFailed);
+
+    if (!suite.jsonFile.empty() && !writeBenchJson(suite.jsonFile.c_str(), results))
+    {
+        printf("Couldn't write %s\n", suite.jsonFile.c_str());
+    }
+
+    if (!suite.csvFile.empty() && !writeBenchCsv(suite.csvFile.c_str(), results))
+    {
+        printf("Couldn't write %s\n", suite.csvFile.c_str());
+    }
+
+    if (suite.record)
+    {
+        for (auto& result : results)
+        {
+            if (result.status != "crash")
+            {
+                expected[result.stats.name] = result.answer;
+            }
+        }
+
+        if (!writeExpectedAnswers(suite.expectedFile.c_str(), expected))
+        {
+            printf("Couldn't write %s\n", suite.expectedFile.c_str());
+        }
+    }
+
+    return numFailed;
+}
+
+/**
+ * SweepOptions - Scaling sweep over one parameter, run at from, from * factor,
+ * from * factor^2, ... up to to.
+ */
+
+struct SweepOptions
+{
+    string param;
+    double from;
+    double to;
+    double factor;
+
+    SweepOptions() : from(0.0), to(0.0), factor(2.0) {};
+};
+
+/**
+ * ParseSweep - Parse the value of a --sweep option, "param,from,to[,factor]".
+ *
+ * @param text  Option value.
+ * @param sweep (out) Parsed sweep. factor stays 2 if not given.
+ *
+ * @return False if the value is malformed or the range doesn't step upward.
+ */
+
+bool ParseSweep(const string &text, SweepOptions &sweep)
+{
+    vector<string> fields;
+    size_t start = 0;
+
+    while (true)
+    {
+        size_t comma = text.find(',', start);
+        fields.push_back(text.substr(start, comma - start));
+
+        if (comma == string::npos)
+        {
+            break;
+        }
+
+        start = comma + 1;
+    }
+
+    if (fields.size() < 3 || fields.size() > 4)
+    {
+        return false;
+    }
+
+    sweep.param = fields[0];
+
+    if (!parseNumber(fields[1].c_str(), sweep.from) || !parseNumber(fields[2].c_str(), sweep.to) ||
+        (fields.size() == 4 && !parseNumber(fields[3].c_str(), sweep.factor)))
+    {
+        return false;
+    }
+
+    return sweep.from > 0.0 && sweep.to >= sweep.from && sweep.factor > 1.0;
+}
+
+/**
+ * RunSweep - Time a test at geometrically spaced values of one parameter, print a row
+ * per size with its answer, and fit the median times to c * size^k.
+ *
+ * @param name    Test name.
+ * @param test    Test to run.
+ * @param params  The test's parameters. The swept one is left at the last size run.
+ * @param sweep   Parameter and range to sweep.
+ * @param options Trial and warm-up counts for each size.
+ *
+ * @return Process exit code. Non-zero if a size doesn't fit the parameter.
+ */
+
+int RunSweep(const string &name, const Test &test, ParamSet &params, const SweepOptions &sweep, const BenchOptions &options)
+{
+    vector<double> sizes;
+    vector<double> times;
+
+    params.Set(sweep.param, sweep.from);
+
+    printf("%s %s, sweeping %s\n\n", name.c_str(), params.ToString().c_str(), sweep.param.c_str());
+    printf("%16s %12s %12s  %s\n", sweep.param.c_str(), "median ms", "min ms", "answer");
+
+    // Step a little past to so rounding error doesn't drop the last size.
+
+    for (double size = sweep.from; size <= sweep.to * (1.0 + 1e-9); size *= sweep.factor)
+    {
+        if (!params.Set(sweep.param, size) && !params.Set(sweep.param, floor(size + 0.5)))
+        {
+            printf("%g doesn't fit %s\n", size, sweep.param.c_str());
+            return 1;
+        }
+
+        double value = params.Get(sweep.param);
+
+        if (!sizes.empty() && value == sizes.back())
+        {
+            continue;
+        }
+
+        OutputCapture capture;
+        capture.Begin();
+
+        BenchStats stats    = runBenchmark(name, test.run, options);
+        string answer       = lastLine(capture.End());
+
+        printf("%16.0f %12.3f %12.3f  %s\n", value, stats.medianMs, stats.minMs, answer.c_str());
+        fflush(stdout);
+
+        sizes.push_back(value);
+        times.push_back(max(stats.medianMs, 1e-6));
+    }
+
+    double coef;
+    double rSquared;
+    double k = fitPowerLaw(sizes, times, coef, rSquared);
+
+    if (isnan(k))
+    {
+        printf("\nNeed at least two sizes to fit.\n");
+    }
+    else
+    {
+        printf("\nFit: time ~ %.4g * %s^%.3f ms (R^2 %.4f)\n", coef, sweep.param.c_str(), k, rSquared);
+    }
+
+    return 0;
+}
+
 /**
  * main - Driver routine for math problems.
  */
@@ -78,10 +769,86 @@ int main(int argc, char** argv)
     }
 
     vector<string> args(argv + 1, argv + argc);
+    BenchOptions options;
+
+    if (args[0] == "--bench")
+    {
+        BenchSuiteOptions suite;
+        suite.exePath = getExecutablePath(argv[0]);
+
+        // Problems can take a while, so by default each runs once with no warm-up.
+
+        options.trials = 1;
+        options.warmup = 0;
+
+        ParseBenchOptions(vector<string>(args.begin() + 1, args.end()), options, &suite);
+
+        return (RunBenchSuite(options, suite) == 0) ? 0 : 1;
+    }
+
+    if (args[0] == "--run-child" && args.size() >= 2)
+    {
+        ParseBenchOptions(vector<string>(args.begin() + 2, args.end()), options, nullptr);
+        return RunChild(args[1], options);
+    }
 
     if (tests.count(args[0]) == 0) DisplayTestsAndExit();
 
-    tests[args[0]]();
+    Test &test = tests[args[0]];
+    ParamSet params;
+    vector<string> rest;
+
+    if (test.bind)
+    {
+        test.bind(params);
+    }
+
+    if (!ParseParams(params, vector<string>(args.begin() + 1, args.end()), rest))
+    {
+        return 1;
+    }
+
+    if (!rest.empty() && rest[0].compare(0, 8, "--sweep=") == 0)
+    {
+        SweepOptions sweep;
+
+        if (params.params.empty())
+        {
+            printf("%s has no parameters to sweep.\n", args[0].c_str());
+            return 1;
+        }
+
+        if (!ParseSweep(rest[0].substr(8), sweep) || !params.Find(sweep.param))
+        {
+            printf("Expected --sweep=param,from,to[,factor] with one of: %s\n", params.ToString().c_str());
+            return 1;
+        }
+
+        // Sweeps run the test many times over, so by default take the median of three
+        // runs per size with no warm-up.
+
+        options.trials = 3;
+        options.warmup = 0;
+
+        ParseBenchOptions(vector<string>(rest.begin() + 1, rest.end()), options, nullptr);
+
+        return RunSweep(args[0], test, params, sweep, options);
+    }
+
+    if (ParseBenchOptions(rest, options, nullptr))
+    {
+        BenchStats stats = runBenchmark(args[0], test.run, options);
+        printBenchStats(stats);
+
+        if (options.counters && !stats.hasCounters)
+        {
+            printf("Hardware counters unavailable.\n");
+        }
+    }
+    else
+    {
+        test.run();
+    }
 
     return 0;
 }
\ No newline at end of file
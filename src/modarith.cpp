@@ -0,0 +1,1111 @@
+#include "modarith.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <vector>
+#include <random>
+
+#ifdef _MSC_VER
+#define TARGET_AVX512IFMA
+#else
+#include <immintrin.h>
+#define TARGET_AVX512IFMA __attribute__((target("avx512f,avx512ifma")))
+#endif
+
+/**
+ * gcdBinary64 - Stein's binary GCD. Strip the common power of two once up front, then
+ * repeatedly shift the trailing zeros out of the difference and subtract the smaller
+ * value from the larger. Shifts, compares and subtracts only, no division.
+ *
+ * @param a First value.
+ * @param b Second value.
+ *
+ * @return Greatest common divisor of a and b. gcd(0, b) = b.
+ */
+
+uint64_t gcdBinary64(uint64_t a, uint64_t b)
+{
+    if (a == 0 || b == 0)
+    {
+        return a | b;
+    }
+
+    uint32_t aShift = ctz64(a);
+    uint32_t bShift = ctz64(b);
+    uint32_t shift  = aShift < bShift ? aShift : bShift;
+
+    b >>= bShift;
+
+    // The next shift comes from the difference, not from the new a, so the ctz overlaps
+    // with the min and abs instead of waiting on them.
+
+    while (a != 0)
+    {
+        a >>= aShift;
+
+        uint64_t diff = b - a;
+        aShift = ctz64(diff | (1ull << 63));
+
+        uint64_t absDiff = (a > b) ? a - b : diff;
+
+        b = (a < b) ? a : b;
+        a = absDiff;
+    }
+
+    return b << shift;
+}
+
+/**
+ * gcdExtended64 - Iterative extended Euclidean algorithm. Carries the remainders along
+ * with the coefficients expressing each one in terms of a and b, so there's no recursion
+ * and no back substitution. The last step's coefficients, which are thrown away, can be
+ * as big as b / gcd and a / gcd and don't fit in 64 signed bits, so the coefficients
+ * are tracked mod 2^64 in unsigned arithmetic. The ones returned are at most half that
+ * size, so the wrapped values cast back to the true ones.
+ *
+ * @param a First value.
+ * @param b Second value.
+ * @param x (out) Coefficient of a.
+ * @param y (out) Coefficient of b, with a * x + b * y = gcd(a, b).
+ *
+ * @return Greatest common divisor of a and b.
+ */
+
+uint64_t gcdExtended64(uint64_t a, uint64_t b, int64_t &x, int64_t &y)
+{
+    uint64_t r0 = a;
+    uint64_t r1 = b;
+    uint64_t s0 = 1;
+    uint64_t s1 = 0;
+    uint64_t t0 = 0;
+    uint64_t t1 = 1;
+
+    while (r1 != 0)
+    {
+        uint64_t q  = r0 / r1;
+        uint64_t r2 = r0 - q * r1;
+        uint64_t s2 = s0 - q * s1;
+        uint64_t t2 = t0 - q * t1;
+
+        r0 = r1;
+        r1 = r2;
+        s0 = s1;
+        s1 = s2;
+        t0 = t1;
+        t1 = t2;
+    }
+
+    x = (int64_t)s0;
+    y = (int64_t)t0;
+
+    return r0;
+}
+
+#ifdef __SIZEOF_INT128__
+
+typedef unsigned __int128 uint128_t;
+
+/**
+ * gcdBinary128 - Stein's binary GCD on 128-bit values. Drops to the 64-bit version as
+ * soon as both values fit in a word.
+ *
+ * @param a First value.
+ * @param b Second value.
+ *
+ * @return Greatest common divisor of a and b.
+ */
+
+uint128_t gcdBinary128(uint128_t a, uint128_t b)
+{
+    if (a == 0 || b == 0)
+    {
+        return a | b;
+    }
+
+    uint32_t shiftA = ((uint64_t)a != 0) ? ctz64((uint64_t)a) : 64 + ctz64((uint64_t)(a >> 64));
+    uint32_t shiftB = ((uint64_t)b != 0) ? ctz64((uint64_t)b) : 64 + ctz64((uint64_t)(b >> 64));
+    uint32_t shift  = shiftA < shiftB ? shiftA : shiftB;
+
+    a >>= shiftA;
+    b >>= shiftB;
+
+    while ((a >> 64) != 0 || (b >> 64) != 0)
+    {
+        if (a > b)
+        {
+            uint128_t tmp = a;
+            a = b;
+            b = tmp;
+        }
+
+        b -= a;
+
+        if (b == 0)
+        {
+            return a << shift;
+        }
+
+        b >>= ((uint64_t)b != 0) ? ctz64((uint64_t)b) : 64 + ctz64((uint64_t)(b >> 64));
+    }
+
+    return (uint128_t)gcdBinary64((uint64_t)a, (uint64_t)b) << shift;
+}
+
+/**
+ * gcdExtended128 - Extended Euclidean algorithm on 128-bit values, using Lehmer's
+ * method. Each round runs Euclid on the leading 62 bits of the two remainders in plain
+ * 64-bit arithmetic, for as long as the quotients are guaranteed to match the full
+ * values' quotients, and collects those steps into a 2x2 matrix. One 128-bit matrix
+ * multiply then applies all of them at once, instead of a 128-bit division per step.
+ * If the leading bits can't settle even one quotient, fall back to a single full step.
+ * Once both remainders fit in a word, finish with gcdExtended64.
+ *
+ * Everything is tracked mod 2^128 in unsigned arithmetic. Remainders and coefficients
+ * are always in range, so the wrapped results are the true values.
+ *
+ * @param a First value.
+ * @param b Second value.
+ * @param x (out) Coefficient of a.
+ * @param y (out) Coefficient of b, with a * x + b * y = gcd(a, b).
+ *
+ * @return Greatest common divisor of a and b.
+ */
+
+uint128_t gcdExtended128(uint128_t a, uint128_t b, __int128 &x, __int128 &y)
+{
+    uint128_t r0 = a;
+    uint128_t r1 = b;
+    uint128_t s0 = 1;
+    uint128_t s1 = 0;
+    uint128_t t0 = 0;
+    uint128_t t1 = 1;
+
+    if (r0 < r1)
+    {
+        swap(r0, r1);
+        swap(s0, s1);
+        swap(t0, t1);
+    }
+
+    while ((r0 >> 64) != 0 && r1 != 0)
+    {
+        uint32_t shift  = 64 - clz64((uint64_t)(r0 >> 64)) + 2;
+        int64_t ah      = (int64_t)(r0 >> shift);
+        int64_t bh      = (int64_t)(r1 >> shift);
+        int64_t ma      = 1;
+        int64_t mb      = 0;
+        int64_t mc      = 0;
+        int64_t md      = 1;
+
+        while (bh + mc > 0 && bh + md > 0)
+        {
+            int64_t q = (ah + ma) / (bh + mc);
+
+            if (q != (ah + mb) / (bh + md))
+            {
+                break;
+            }
+
+            int64_t tmp;
+
+            tmp = ma - q * mc; ma = mc; mc = tmp;
+            tmp = mb - q * md; mb = md; md = tmp;
+            tmp = ah - q * bh; ah = bh; bh = tmp;
+        }
+
+        uint128_t r2;
+        uint128_t s2;
+        uint128_t t2;
+
+        if (mb == 0)
+        {
+            uint128_t q = r0 / r1;
+
+            r2 = r0 - q * r1;
+            s2 = s0 - q * s1;
+            t2 = t0 - q * t1;
+
+            r0 = r1;
+            s0 = s1;
+            t0 = t1;
+        }
+        else
+        {
+            uint128_t a0 = (uint128_t)(__int128)ma;
+            uint128_t b0 = (uint128_t)(__int128)mb;
+            uint128_t c0 = (uint128_t)(__int128)mc;
+            uint128_t d0 = (uint128_t)(__int128)md;
+
+            r2 = c0 * r0 + d0 * r1;
+            s2 = c0 * s0 + d0 * s1;
+            t2 = c0 * t0 + d0 * t1;
+
+            r0 = a0 * r0 + b0 * r1;
+            s0 = a0 * s0 + b0 * s1;
+            t0 = a0 * t0 + b0 * t1;
+        }
+
+        r1 = r2;
+        s1 = s2;
+        t1 = t2;
+    }
+
+    if (r1 == 0)
+    {
+        x = (__int128)s0;
+        y = (__int128)t0;
+        return r0;
+    }
+
+    // Both remainders fit in 64 bits now. Finish in single words and fold the final
+    // coefficients back into the running ones.
+
+    int64_t u;
+    int64_t v;
+    uint64_t g = gcdExtended64((uint64_t)r0, (uint64_t)r1, u, v);
+
+    x = (__int128)((uint128_t)(__int128)u * s0 + (uint128_t)(__int128)v * s1);
+    y = (__int128)((uint128_t)(__int128)u * t0 + (uint128_t)(__int128)v * t1);
+
+    return g;
+}
+
+#endif
+
+/**
+ * inverseMod64 - Get the inverse of a mod n with the extended Euclidean algorithm,
+ * run iteratively. Only the coefficient of a is tracked, and it's kept mod n as it goes
+ * so nothing overflows.
+ *
+ * @param a Value to invert.
+ * @param n Modulus.
+ *
+ * @return x with a * x = 1 mod n, or 0 if a and n aren't coprime.
+ */
+
+uint64_t inverseMod64(uint64_t a, uint64_t n)
+{
+    if (n == 1)
+    {
+        return 0;
+    }
+
+    uint64_t r0 = n;
+    uint64_t r1 = a % n;
+    uint64_t t0 = 0;
+    uint64_t t1 = 1;
+
+    while (r1 != 0)
+    {
+        uint64_t q  = r0 / r1;
+        uint64_t r2 = r0 - q * r1;
+
+        // t2 = t0 - q * t1 mod n.
+
+        uint64_t hi;
+        uint64_t lo = mul128(q % n, t1, hi);
+        uint64_t qt;
+        div128(hi % n, lo, n, qt);
+
+        uint64_t t2 = (t0 >= qt) ? t0 - qt : t0 + (n - qt);
+
+        r0 = r1;
+        r1 = r2;
+        t0 = t1;
+        t1 = t2;
+    }
+
+    return (r0 == 1) ? t0 : 0;
+}
+
+/**
+ * Montgomery64::Init - Compute n^-1 mod 2^64 by Newton iteration (each step doubles the
+ * number of correct bits, and n is its own inverse mod 8), R mod n, and R^2 mod n.
+ *
+ * @param nIn Odd modulus.
+ */
+
+void Montgomery64::Init(uint64_t nIn)
+{
+    assert(nIn & 1);
+
+    n       = nIn;
+    nInv    = n;
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        nInv *= 2 - n * nInv;
+    }
+
+    one = (0 - n) % n;
+    div128(one, 0, n, r2);
+}
+
+/**
+ * Montgomery64::Inverse - Modular inverse in Montgomery form.
+ *
+ * @param a Value to invert, in Montgomery form.
+ *
+ * @return a^-1 in Montgomery form, or 0 if a isn't invertible mod n.
+ */
+
+uint64_t Montgomery64::Inverse(uint64_t a) const
+{
+    return ToMont(inverseMod64(FromMont(a), n));
+}
+
+/**
+ * Barrett64::Init - Compute mu = floor(2^128 / n) as two words. The high word is
+ * floor(2^64 / n), and the low word comes from dividing the remainder back in.
+ *
+ * @param nIn Modulus, 1 < nIn < 2^62.
+ */
+
+void Barrett64::Init(uint64_t nIn)
+{
+    assert(nIn > 1 && nIn < (1ULL << 62));
+
+    n = nIn;
+
+    uint64_t rem = (0 - n) % n;
+    muHi = (0 - n) / n + 1;
+    muLo = div128(rem, 0, n, rem);
+}
+
+/**
+ * Barrett64::Inverse - Modular inverse.
+ *
+ * @param a Value to invert.
+ *
+ * @return a^-1 mod n, or 0 if a isn't invertible mod n.
+ */
+
+uint64_t Barrett64::Inverse(uint64_t a) const
+{
+    return inverseMod64(a, n);
+}
+
+/**
+ * powMod64 - Quickly compute b^e mod n 64-bit uints. Products are 128 bits wide, so any
+ * modulus works. Odd moduli go through Montgomery multiplication and even ones through
+ * Barrett reduction, so there's no divide per step.
+ *
+ * @param b Base value.
+ * @param e Exponent.
+ * @param n Modulus.
+ *
+ * @return result of b^e mod n.
+ */
+
+uint64_t powMod64(uint64_t b, uint64_t e, uint64_t n)
+{
+    assert(n > 0);
+
+    if (n == 1)
+    {
+        return 0;
+    }
+
+    if (n & 1)
+    {
+        Montgomery64 mont;
+        mont.Init(n);
+
+        return mont.FromMont(mont.Pow(mont.ToMont(b), e));
+    }
+
+    if (n < (1ULL << 62))
+    {
+        Barrett64 bar;
+        bar.Init(n);
+
+        return bar.Pow(b % n, e);
+    }
+
+    // Even moduli past Barrett64's range, take the remainder of each 128-bit product.
+
+    uint64_t result = 1;
+    uint64_t hi;
+    uint64_t lo;
+
+    b %= n;
+
+    while (e > 0)
+    {
+        if (e & 1)
+        {
+            lo = mul128(result, b, hi);
+            div128(hi, lo, n, result);
+        }
+
+        lo = mul128(b, b, hi);
+        div128(hi, lo, n, b);
+        e >>= 1;
+    }
+
+    return result;
+}
+
+// Lanes handled together by the batched exponentiation kernels.
+
+static const size_t powLanesIfma    = 8;
+static const size_t powLanesScalar  = 4;
+
+/**
+ * montMul52 - Montgomery multiply on 8 lanes with R = 2^52, using the AVX-512 IFMA 52-bit
+ * multiply-adds. Inputs are below n < 2^52. The low and high halves of a * b come from
+ * one madd52lo / madd52hi pair, m = lo * -n^-1 mod 2^52 from another, and adding m * n
+ * zeroes the low half, leaving a carry of 0 or 1 into the high half. The result is below
+ * 2n, and min(r, r - n) picks the reduced value without a compare.
+ */
+
+TARGET_AVX512IFMA
+static inline __m512i montMul52(__m512i a, __m512i b, __m512i n, __m512i nNeg)
+{
+    __m512i zero = _mm512_setzero_si512();
+    __m512i lo   = _mm512_madd52lo_epu64(zero, a, b);
+    __m512i hi   = _mm512_madd52hi_epu64(zero, a, b);
+    __m512i m    = _mm512_madd52lo_epu64(zero, lo, nNeg);
+
+    hi = _mm512_madd52hi_epu64(hi, m, n);
+    lo = _mm512_madd52lo_epu64(lo, m, n);
+    hi = _mm512_add_epi64(hi, _mm512_srli_epi64(lo, 52));
+
+    return _mm512_min_epu64(hi, _mm512_sub_epi64(hi, n));
+}
+
+/**
+ * powModBatchIfma - Batched b^e mod an odd n < 2^52, 8 lanes at a time in AVX-512
+ * registers. Exponents are walked right to left in lockstep. Each step squares every
+ * lane's base and multiplies it into the lanes whose current exponent bit is set, until
+ * every lane's exponent runs out.
+ *
+ * @param bases Base for each lane.
+ * @param exps  Exponent for each lane, or null to use exp for all of them.
+ * @param exp   Shared exponent when exps is null.
+ * @param mod   Odd modulus below 2^52.
+ * @param out   (out) b^e mod n for each lane.
+ * @param n     Number of lanes.
+ */
+
+TARGET_AVX512IFMA
+static void powModBatchIfma(const uint64_t* bases, const uint64_t* exps, uint64_t exp, uint64_t mod, uint64_t* out, size_t n)
+{
+    const uint64_t mask52 = (1ULL << 52) - 1;
+
+    uint64_t inv = mod;
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        inv *= 2 - mod * inv;
+    }
+
+    uint64_t r1 = (1ULL << 52) % mod;
+    uint64_t hi;
+    uint64_t lo = mul128(r1, r1, hi);
+    uint64_t r2;
+    div128(hi, lo, mod, r2);
+
+    __m512i nVec    = _mm512_set1_epi64((long long)mod);
+    __m512i nNeg    = _mm512_set1_epi64((long long)((0 - inv) & mask52));
+    __m512i oneVec  = _mm512_set1_epi64((long long)r1);
+    __m512i r2Vec   = _mm512_set1_epi64((long long)r2);
+    __m512i bitOne  = _mm512_set1_epi64(1);
+
+    for (size_t i = 0; i < n; i += powLanesIfma)
+    {
+        size_t lanes = (n - i < powLanesIfma) ? n - i : powLanesIfma;
+
+        uint64_t b[powLanesIfma] = {};
+        uint64_t e[powLanesIfma] = {};
+
+        for (size_t k = 0; k < lanes; k++)
+        {
+            b[k] = (bases[i + k] < mod) ? bases[i + k] : bases[i + k] % mod;
+            e[k] = exps ? exps[i + k] : exp;
+        }
+
+        __m512i x       = montMul52(_mm512_loadu_si512(b), r2Vec, nVec, nNeg);
+        __m512i eVec    = _mm512_loadu_si512(e);
+        __m512i result  = oneVec;
+
+        while (_mm512_test_epi64_mask(eVec, eVec))
+        {
+            __mmask8 odd = _mm512_test_epi64_mask(eVec, bitOne);
+
+            result  = _mm512_mask_mov_epi64(result, odd, montMul52(result, x, nVec, nNeg));
+            x       = montMul52(x, x, nVec, nNeg);
+            eVec    = _mm512_srli_epi64(eVec, 1);
+        }
+
+        _mm512_storeu_si512(b, montMul52(result, bitOne, nVec, nNeg));
+
+        for (size_t k = 0; k < lanes; k++)
+        {
+            out[i + k] = b[k];
+        }
+    }
+}
+
+/**
+ * powModBatchScalar - Batched b^e mod an odd n with Montgomery64, 4 lanes at a time.
+ * The lanes are independent, so their 128-bit multiplies overlap in the pipeline, and
+ * the multiply for a clear exponent bit is discarded with a select instead of a branch.
+ *
+ * @param bases Base for each lane.
+ * @param exps  Exponent for each lane, or null to use exp for all of them.
+ * @param exp   Shared exponent when exps is null.
+ * @param mod   Odd modulus.
+ * @param out   (out) b^e mod n for each lane.
+ * @param n     Number of lanes.
+ */
+
+static void powModBatchScalar(const uint64_t* bases, const uint64_t* exps, uint64_t exp, uint64_t mod, uint64_t* out, size_t n)
+{
+    Montgomery64 mont;
+    mont.Init(mod);
+
+    for (size_t i = 0; i < n; i += powLanesScalar)
+    {
+        size_t lanes = (n - i < powLanesScalar) ? n - i : powLanesScalar;
+
+        uint64_t x[powLanesScalar];
+        uint64_t e[powLanesScalar];
+        uint64_t r[powLanesScalar];
+
+        for (size_t k = 0; k < powLanesScalar; k++)
+        {
+            x[k] = (k < lanes) ? mont.ToMont(bases[i + k]) : 0;
+            e[k] = (k < lanes) ? (exps ? exps[i + k] : exp) : 0;
+            r[k] = mont.one;
+        }
+
+        while (e[0] | e[1] | e[2] | e[3])
+        {
+            for (size_t k = 0; k < powLanesScalar; k++)
+            {
+                uint64_t t = mont.Mul(r[k], x[k]);
+                r[k] = (e[k] & 1) ? t : r[k];
+                x[k] = mont.Mul(x[k], x[k]);
+                e[k] >>= 1;
+            }
+        }
+
+        for (size_t k = 0; k < lanes; k++)
+        {
+            out[i + k] = mont.FromMont(r[k]);
+        }
+    }
+}
+
+/**
+ * powModBatchImpl - Pick a kernel for a batch. Odd moduli below 2^52 use AVX-512 IFMA
+ * when the CPU has it, other odd moduli use the scalar Montgomery lanes, and even
+ * moduli go one at a time through powMod64's Barrett path.
+ */
+
+static void powModBatchImpl(const uint64_t* bases, const uint64_t* exps, uint64_t exp, uint64_t mod, uint64_t* out, size_t n)
+{
+    static const bool hasIfma = cpuHasAvx512Ifma();
+
+    assert(mod > 0);
+
+    if (mod == 1)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            out[i] = 0;
+        }
+
+        return;
+    }
+
+    if ((mod & 1) == 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            out[i] = powMod64(bases[i], exps ? exps[i] : exp, mod);
+        }
+
+        return;
+    }
+
+    if (hasIfma && mod < (1ULL << 52))
+    {
+        powModBatchIfma(bases, exps, exp, mod, out, n);
+    }
+    else
+    {
+        powModBatchScalar(bases, exps, exp, mod, out, n);
+    }
+}
+
+/**
+ * powModBatchParallelImpl - Split a batch into chunks and run them on the shared pool.
+ */
+
+static void powModBatchParallelImpl(const uint64_t* bases, const uint64_t* exps, uint64_t exp, uint64_t mod, uint64_t* out, size_t n)
+{
+    const size_t chunkSize  = 4096;
+    size_t numChunks        = (n + chunkSize - 1) / chunkSize;
+
+    ParallelFor(0, numChunks, [&](uint64_t chunk)
+    {
+        size_t lo   = (size_t)chunk * chunkSize;
+        size_t len  = (n - lo < chunkSize) ? n - lo : chunkSize;
+
+        powModBatchImpl(bases + lo, exps ? exps + lo : nullptr, exp, mod, out + lo, len);
+    });
+}
+
+/**
+ * powModBatch - Compute bases[i]^exps[i] mod mod for i in [0, n). Lanes are processed in
+ * lockstep, 8 wide with AVX-512 IFMA for odd moduli below 2^52 on CPUs that have it,
+ * else 4 interleaved scalar Montgomery lanes.
+ *
+ * @param bases Bases.
+ * @param exps  Exponents.
+ * @param mod   Modulus.
+ * @param out   (out) Results. May alias bases.
+ * @param n     Number of values.
+ */
+
+void powModBatch(const uint64_t* bases, const uint64_t* exps, uint64_t mod, uint64_t* out, size_t n)
+{
+    powModBatchImpl(bases, exps, 0, mod, out, n);
+}
+
+/**
+ * powModBatch - Same as above, with one exponent shared by every base.
+ *
+ * @param bases Bases.
+ * @param exp   Exponent.
+ * @param mod   Modulus.
+ * @param out   (out) Results. May alias bases.
+ * @param n     Number of values.
+ */
+
+void powModBatch(const uint64_t* bases, uint64_t exp, uint64_t mod, uint64_t* out, size_t n)
+{
+    powModBatchImpl(bases, nullptr, exp, mod, out, n);
+}
+
+/**
+ * powModBatchParallel - powModBatch split into chunks of 4096 across the shared thread
+ * pool.
+ *
+ * @param bases Bases.
+ * @param exps  Exponents.
+ * @param mod   Modulus.
+ * @param out   (out) Results. May alias bases.
+ * @param n     Number of values.
+ */
+
+void powModBatchParallel(const uint64_t* bases, const uint64_t* exps, uint64_t mod, uint64_t* out, size_t n)
+{
+    powModBatchParallelImpl(bases, exps, 0, mod, out, n);
+}
+
+/**
+ * powModBatchParallel - Same as above, with one exponent shared by every base.
+ *
+ * @param bases Bases.
+ * @param exp   Exponent.
+ * @param mod   Modulus.
+ * @param out   (out) Results. May alias bases.
+ * @param n     Number of values.
+ */
+
+void powModBatchParallel(const uint64_t* bases, uint64_t exp, uint64_t mod, uint64_t* out, size_t n)
+{
+    powModBatchParallelImpl(bases, nullptr, exp, mod, out, n);
+}
+
+/**
+ * gcdEuclid64 - Reference gcd by plain Euclid, for checking the fast versions.
+ *
+ * @param a First value.
+ * @param b Second value.
+ *
+ * @return Greatest common divisor of a and b.
+ */
+
+static uint64_t gcdEuclid64(uint64_t a, uint64_t b)
+{
+    while (b != 0)
+    {
+        uint64_t r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+#ifdef __SIZEOF_INT128__
+
+static uint128_t gcdEuclid128(uint128_t a, uint128_t b)
+{
+    while (b != 0)
+    {
+        uint128_t r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+/**
+ * randomBits128 - Random value with a random bit length up to maxBits, so tests see
+ * small, mixed and full width inputs.
+ *
+ * @param maxBits Largest bit length, 1 to 128.
+ * @param rng     Random source.
+ *
+ * @return The value.
+ */
+
+static uint128_t randomBits128(uint32_t maxBits, mt19937_64 &rng)
+{
+    uint32_t bits   = 1 + (uint32_t)(rng() % maxBits);
+    uint128_t value = ((uint128_t)rng() << 64) | rng();
+
+    return (bits == 128) ? value : value & (((uint128_t)1 << bits) - 1);
+}
+
+/**
+ * bezoutHolds128 - Check a * x + b * y = g exactly. The Bezout coefficients are at most
+ * b / g and a / g in size, so the true sum is below 2^130 in magnitude, and matching it
+ * both mod 2^128 and mod a 61-bit prime pins it down.
+ *
+ * @param a First value.
+ * @param b Second value.
+ * @param x Coefficient of a.
+ * @param y Coefficient of b.
+ * @param g Claimed gcd.
+ *
+ * @return True if the coefficients are in range and the identity holds.
+ */
+
+static bool bezoutHolds128(uint128_t a, uint128_t b, __int128 x, __int128 y, uint128_t g)
+{
+    const uint64_t p = (1ull << 61) - 1;
+
+    uint128_t xAbs = (x < 0) ? 0 - (uint128_t)x : (uint128_t)x;
+    uint128_t yAbs = (y < 0) ? 0 - (uint128_t)y : (uint128_t)y;
+
+    if (g == 0 || xAbs > (b / g > 1 ? b / g : 1) || yAbs > (a / g > 1 ? a / g : 1))
+    {
+        return g == 0 && a == 0 && b == 0;
+    }
+
+    if (a * (uint128_t)x + b * (uint128_t)y != g)
+    {
+        return false;
+    }
+
+    uint128_t xMod = (x < 0) ? p - xAbs % p : xAbs % p;
+    uint128_t yMod = (y < 0) ? p - yAbs % p : yAbs % p;
+
+    return ((a % p) * xMod % p + (b % p) * yMod % p) % p == g % p;
+}
+
+#endif
+
+/**
+ * TestGcd - Check the binary and extended gcds against plain Euclid on random inputs
+ * of mixed sizes, some sharing a random common factor, plus zeros and consecutive
+ * Fibonacci numbers (Euclid's worst case). The extended versions also have to satisfy
+ * a * x + b * y = gcd exactly, with coefficients no bigger than b / gcd and a / gcd.
+ */
+
+void TestGcd()
+{
+    const uint32_t numTrials = 200000;
+
+    mt19937_64 rng(15);
+    vector<pair<uint64_t, uint64_t>> pairs64 = { { 0, 0 }, { 0, 7 }, { 7, 0 }, { 1, ~0ull }, { ~0ull, ~0ull },
+        { 1ull << 63, ~0ull } };
+
+    uint64_t f0 = 0;
+    uint64_t f1 = 1;
+
+    while (f1 <= ~0ull - f0)
+    {
+        uint64_t f2 = f0 + f1;
+        pairs64.push_back({ f2, f1 });
+        f0 = f1;
+        f1 = f2;
+    }
+
+    for (uint32_t i = 0; i < numTrials; i++)
+    {
+        uint64_t a = rng() >> (rng() % 64);
+        uint64_t b = rng() >> (rng() % 64);
+
+        if (i % 4 == 0)
+        {
+            uint64_t c = 1 + (rng() >> (40 + rng() % 24));
+            a = (a / c) * c;
+            b = (b / c) * c;
+        }
+
+        pairs64.push_back({ a, b });
+    }
+
+    uint32_t fails64 = 0;
+
+    for (auto& ab : pairs64)
+    {
+        uint64_t a = ab.first;
+        uint64_t b = ab.second;
+        int64_t x;
+        int64_t y;
+
+        uint64_t g  = gcdEuclid64(a, b);
+        uint64_t gx = gcdExtended64(a, b, x, y);
+
+        fails64 += (gcdBinary64(a, b) != g) || (gx != g);
+
+#ifdef __SIZEOF_INT128__
+        fails64 += (gx == g) && ((__int128)a * x + (__int128)b * y != (__int128)g);
+#endif
+    }
+
+    printf("64-bit gcd mismatches: %u of %u\n", fails64, (uint32_t)pairs64.size());
+
+#ifdef __SIZEOF_INT128__
+    vector<pair<uint128_t, uint128_t>> pairs128 = { { 0, 0 }, { 0, 7 }, { 7, 0 }, { 1, ~(uint128_t)0 }, { ~(uint128_t)0, ~(uint128_t)0 },
+        { (uint128_t)1 << 63, ~0ull } };
+
+    uint128_t g0 = 0;
+    uint128_t g1 = 1;
+
+    while (g1 <= ~(uint128_t)0 - g0)
+    {
+        uint128_t g2 = g0 + g1;
+        pairs128.push_back({ g2, g1 });
+        g0 = g1;
+        g1 = g2;
+    }
+
+    for (uint32_t i = 0; i < numTrials; i++)
+    {
+        uint128_t a = randomBits128(128, rng);
+        uint128_t b = randomBits128(128, rng);
+
+        if (i % 4 == 0)
+        {
+            uint128_t c = 1 + randomBits128(64, rng);
+            a = (a / c) * c;
+            b = (b / c) * c;
+        }
+
+        pairs128.push_back({ a, b });
+    }
+
+    uint32_t fails128 = 0;
+
+    for (auto& ab : pairs128)
+    {
+        uint128_t a = ab.first;
+        uint128_t b = ab.second;
+        __int128 x;
+        __int128 y;
+
+        uint128_t g  = gcdEuclid128(a, b);
+        uint128_t gx = gcdExtended128(a, b, x, y);
+
+        fails128 += (gcdBinary128(a, b) != g) || (gx != g) || !bezoutHolds128(a, b, x, y, g);
+    }
+
+    printf("128-bit gcd mismatches: %u of %u\n", fails128, (uint32_t)pairs128.size());
+#endif
+}
+
+#ifdef __SIZEOF_INT128__
+
+/**
+ * powModReference - Square and multiply with a 128-bit % per step, for checking the
+ * Barrett and Montgomery powers. powMod64 itself runs on those, so it can't stand in.
+ *
+ * @param b Base value.
+ * @param e Exponent.
+ * @param n Modulus.
+ *
+ * @return b^e mod n.
+ */
+
+static uint64_t powModReference(uint64_t b, uint64_t e, uint64_t n)
+{
+    uint64_t result = 1 % n;
+
+    b %= n;
+
+    while (e > 0)
+    {
+        if (e & 1)
+        {
+            result = (uint64_t)((uint128_t)result * b % n);
+        }
+
+        b = (uint64_t)((uint128_t)b * b % n);
+        e >>= 1;
+    }
+
+    return result;
+}
+
+#endif
+
+/**
+ * TestModArith - Check Barrett64 and Montgomery64 against plain 128-bit % on random
+ * moduli of every size they take (Barrett's up to 2^62 and even, Montgomery's odd up to
+ * 2^64), with operands that include 0, 1 and n - 1. Products, sums, differences, powers
+ * and inverses are all compared.
+ *
+ * Then check powModBatch and powModBatchParallel against the same reference on moduli
+ * that reach every kernel (1, even, odd just below and above the IFMA 2^52 limit, and
+ * near 2^64), for batch sizes that leave every possible partial group of 4 or 8 lanes,
+ * with per-lane and shared exponents.
+ */
+
+void TestModArith()
+{
+#ifdef __SIZEOF_INT128__
+    const uint32_t numModuli    = 2000;
+    const uint32_t numOperands  = 100;
+
+    mt19937_64 rng(13);
+
+    uint32_t barrettFails   = 0;
+    uint32_t montFails      = 0;
+    uint32_t checks         = 0;
+
+    for (uint32_t i = 0; i < numModuli; i++)
+    {
+        uint64_t barrettN   = 2 + (rng() >> (2 + rng() % 62)) % ((1ull << 62) - 2);
+        uint64_t montN      = (rng() >> (rng() % 63)) | 1;
+
+        montN = (montN == 1) ? 3 : montN;
+
+        Barrett64 bar;
+        bar.Init(barrettN);
+
+        Montgomery64 mont;
+        mont.Init(montN);
+
+        for (uint32_t j = 0; j < numOperands; j++)
+        {
+            uint64_t r[2];
+
+            for (uint32_t k = 0; k < 2; k++)
+            {
+                uint64_t pick = rng();
+                r[k] = (pick % 8 == 0) ? 0 : (pick % 8 == 1) ? 1 : (pick % 8 == 2) ? ~0ull : rng();
+            }
+
+            uint64_t e = rng() >> (rng() % 64);
+
+            // Barrett.
+
+            uint64_t n = barrettN;
+            uint64_t a = r[0] % n;
+            uint64_t b = r[1] % n;
+
+            uint64_t prod   = (uint64_t)((uint128_t)a * b % n);
+            uint64_t sum    = (uint64_t)(((uint128_t)a + b) % n);
+            uint64_t diff   = (uint64_t)(((uint128_t)a + n - b) % n);
+            uint64_t inv    = bar.Inverse(a);
+
+            barrettFails += (bar.Mul(a, b) != prod) || (bar.Add(a, b) != sum) || (bar.Sub(a, b) != diff) ||
+                (bar.Pow(a, e) != powModReference(a, e, n)) ||
+                (inv != 0 ? (uint128_t)a * inv % n != 1 : gcdEuclid64(a, n) == 1);
+
+            // Montgomery.
+
+            n = montN;
+            a = r[0] % n;
+            b = r[1] % n;
+
+            uint64_t aM = mont.ToMont(a);
+            uint64_t bM = mont.ToMont(b);
+
+            prod    = (uint64_t)((uint128_t)a * b % n);
+            sum     = (uint64_t)(((uint128_t)a + b) % n);
+            diff    = (uint64_t)(((uint128_t)a + n - b) % n);
+            inv     = mont.FromMont(mont.Inverse(aM));
+
+            montFails += (mont.FromMont(aM) != a) || (mont.FromMont(mont.Mul(aM, bM)) != prod) ||
+                (mont.FromMont(mont.Add(aM, bM)) != sum) || (mont.FromMont(mont.Sub(aM, bM)) != diff) ||
+                (mont.FromMont(mont.Pow(aM, e)) != powModReference(a, e, n)) ||
+                (inv != 0 ? (uint128_t)a * inv % n != 1 : gcdEuclid64(a, n) == 1);
+
+            checks++;
+        }
+    }
+
+    printf("Barrett64 mismatches: %u of %u\n", barrettFails, checks);
+    printf("Montgomery64 mismatches: %u of %u\n", montFails, checks);
+
+    const uint64_t batchModuli[] =
+    {
+        1, 2, 3, 4, 6, 1000003, (1ull << 52) - 1, (1ull << 52) + 1, (1ull << 52) + 3,
+        1ull << 62, ~0ull, ~0ull - 58
+    };
+
+    vector<size_t> batchSizes;
+
+    for (size_t len = 0; len <= 17; len++)
+    {
+        batchSizes.push_back(len);
+    }
+
+    batchSizes.push_back(5000);
+
+    uint32_t batchFails     = 0;
+    uint32_t batchChecks    = 0;
+
+    for (uint64_t mod : batchModuli)
+    {
+        for (size_t len : batchSizes)
+        {
+            vector<uint64_t> bases(len);
+            vector<uint64_t> exps(len);
+            uint64_t exp = rng();
+
+            for (size_t i = 0; i < len; i++)
+            {
+                uint64_t pick = rng();
+                bases[i]    = (pick % 8 == 0) ? 0 : (pick % 8 == 1) ? 1 : (pick % 8 == 2) ? mod - 1 : rng();
+                exps[i]     = (pick % 5 == 0) ? 0 : rng() >> (rng() % 64);
+            }
+
+            vector<uint64_t> outs[4];
+
+            for (auto& out : outs)
+            {
+                out.assign(len, ~0ull);
+            }
+
+            powModBatch(bases.data(), exps.data(), mod, outs[0].data(), len);
+            powModBatchParallel(bases.data(), exps.data(), mod, outs[1].data(), len);
+            powModBatch(bases.data(), exp, mod, outs[2].data(), len);
+            powModBatchParallel(bases.data(), exp, mod, outs[3].data(), len);
+
+            for (size_t i = 0; i < len; i++)
+            {
+                uint64_t perLane    = powModReference(bases[i], exps[i], mod);
+                uint64_t shared     = powModReference(bases[i], exp, mod);
+
+                batchFails += (outs[0][i] != perLane) || (outs[1][i] != perLane) ||
+                    (outs[2][i] != shared) || (outs[3][i] != shared);
+
+                batchChecks++;
+            }
+        }
+    }
+
+    printf("powModBatch mismatches: %u of %u\n", batchFails, batchChecks);
+#endif
+}
\ No newline at end of file
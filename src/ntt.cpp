@@ -0,0 +1,842 @@
+#include "ntt.h"
+#include "intrinsics.h"
+#include "modarith.h"
+#include "threadpool.h"
+#include "benchmark.h"
+#include <map>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER
+#define TARGET_AVX2
+#else
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+struct NTTPrime
+{
+    uint32_t mod;
+    uint32_t generator;
+    uint32_t maxLog;
+};
+
+// NTT-friendly primes c * 2^k + 1 below 2^30, with a primitive root of each. The
+// largest first, so one or two primes cover the widest range of small results.
+
+static const NTTPrime nttPrimes[] =
+{
+    { 998244353, 3, 23 },
+    { 469762049, 3, 26 },
+    { 167772161, 3, 25 }
+};
+
+static const uint32_t numNttPrimes      = 3;
+static const uint32_t maxConvolveLog    = 23;
+static const size_t schoolbookMaxLen    = 32;
+
+/**
+ * NTTPlan::Init - Build the Montgomery constants and every stage's roots of unity for a
+ * size.
+ *
+ * @param modIn     Odd prime below 2^30 with size dividing modIn - 1.
+ * @param generator Primitive root mod modIn.
+ * @param sizeIn    Transform size. Must be a power of two.
+ */
+
+void NTTPlan::Init(uint32_t modIn, uint32_t generator, uint32_t sizeIn)
+{
+    assert(modIn & 1);
+    assert(modIn < (1u << 30));
+    assert(sizeIn > 0 && (sizeIn & (sizeIn - 1)) == 0);
+    assert((modIn - 1) % sizeIn == 0);
+
+    mod     = modIn;
+    size    = sizeIn;
+
+    // p^-1 mod 2^32 by Newton's iteration. Each step doubles the correct low bits, and
+    // p is its own inverse mod 8.
+
+    uint32_t inv = mod;
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        inv *= 2 - mod * inv;
+    }
+
+    nInv = 0 - inv;
+
+    uint64_t r  = (1ull << 32) % mod;
+    r2          = (uint32_t)(r * r % mod);
+
+    roots.assign(size, 0);
+    invRoots.assign(size, 0);
+
+    for (uint32_t len = 1; len < size; len <<= 1)
+    {
+        uint64_t w      = powMod64(generator, (mod - 1) / (2 * len), mod);
+        uint64_t wInv   = powMod64(w, mod - 2, mod);
+        uint64_t cur    = 1;
+        uint64_t curInv = 1;
+
+        for (uint32_t j = 0; j < len; j++)
+        {
+            roots[len + j]      = (uint32_t)((cur << 32) % mod);
+            invRoots[len + j]   = (uint32_t)((curInv << 32) % mod);
+            cur                 = cur * w % mod;
+            curInv              = curInv * wInv % mod;
+        }
+    }
+
+    uint64_t sizeInv    = powMod64(size, mod - 2, mod);
+    scale               = (uint32_t)((sizeInv << 32) % mod);
+}
+
+/**
+ * forwardStage - One decimation in frequency stage: butterflies between the halves of
+ * each block of 2 * len values, the difference scaled by that block size's roots.
+ */
+
+static void forwardStage(const NTTPlan &plan, uint32_t* pData, uint32_t len)
+{
+    const uint32_t* pRoots = &plan.roots[len];
+
+    for (uint32_t i = 0; i < plan.size; i += 2 * len)
+    {
+        uint32_t* pLo = pData + i;
+        uint32_t* pHi = pData + i + len;
+
+        for (uint32_t j = 0; j < len; j++)
+        {
+            uint32_t u  = pLo[j];
+            uint32_t v  = pHi[j];
+            pLo[j]      = plan.Add(u, v);
+            pHi[j]      = plan.Mul(plan.Sub(u, v), pRoots[j]);
+        }
+    }
+}
+
+/**
+ * inverseStage - One decimation in time stage, undoing forwardStage up to a factor of 2.
+ */
+
+static void inverseStage(const NTTPlan &plan, uint32_t* pData, uint32_t len)
+{
+    const uint32_t* pRoots = &plan.invRoots[len];
+
+    for (uint32_t i = 0; i < plan.size; i += 2 * len)
+    {
+        uint32_t* pLo = pData + i;
+        uint32_t* pHi = pData + i + len;
+
+        for (uint32_t j = 0; j < len; j++)
+        {
+            uint32_t u  = pLo[j];
+            uint32_t v  = plan.Mul(pHi[j], pRoots[j]);
+            pLo[j]      = plan.Add(u, v);
+            pHi[j]      = plan.Sub(u, v);
+        }
+    }
+}
+
+/**
+ * mulAvx2 - NTTPlan::Mul on 8 lanes. _mm256_mul_epu32 multiplies the even 32-bit lanes
+ * only, so the odd lanes are shifted down and done as a second set. Each REDC leaves its
+ * result in the high half of its 64-bit lane, where the blend picks it up. The result is
+ * below 2p, and min(x, x - p) as unsigned is the reduced value either way.
+ */
+
+TARGET_AVX2
+static inline __m256i mulAvx2(__m256i a, __m256i b, __m256i mod, __m256i nInv)
+{
+    __m256i prodEven    = _mm256_mul_epu32(a, b);
+    __m256i prodOdd     = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i mEven       = _mm256_mul_epu32(prodEven, nInv);
+    __m256i mOdd        = _mm256_mul_epu32(prodOdd, nInv);
+    __m256i tEven       = _mm256_add_epi64(prodEven, _mm256_mul_epu32(mEven, mod));
+    __m256i tOdd        = _mm256_add_epi64(prodOdd, _mm256_mul_epu32(mOdd, mod));
+    __m256i res         = _mm256_blend_epi32(_mm256_srli_epi64(tEven, 32), tOdd, 0xAA);
+
+    return _mm256_min_epu32(res, _mm256_sub_epi32(res, mod));
+}
+
+/**
+ * forwardStageAvx2 - forwardStage eight butterflies at a time. len must be a multiple
+ * of 8.
+ */
+
+TARGET_AVX2
+static void forwardStageAvx2(const NTTPlan &plan, uint32_t* pData, uint32_t len)
+{
+    const uint32_t* pRoots  = &plan.roots[len];
+    __m256i mod             = _mm256_set1_epi32((int)plan.mod);
+    __m256i nInv            = _mm256_set1_epi32((int)plan.nInv);
+
+    for (uint32_t i = 0; i < plan.size; i += 2 * len)
+    {
+        uint32_t* pLo = pData + i;
+        uint32_t* pHi = pData + i + len;
+
+        for (uint32_t j = 0; j < len; j += 8)
+        {
+            __m256i u   = _mm256_loadu_si256((const __m256i*)(pLo + j));
+            __m256i v   = _mm256_loadu_si256((const __m256i*)(pHi + j));
+            __m256i w   = _mm256_loadu_si256((const __m256i*)(pRoots + j));
+            __m256i sum = _mm256_add_epi32(u, v);
+            __m256i dif = _mm256_sub_epi32(u, v);
+
+            sum = _mm256_min_epu32(sum, _mm256_sub_epi32(sum, mod));
+            dif = _mm256_min_epu32(dif, _mm256_add_epi32(dif, mod));
+
+            _mm256_storeu_si256((__m256i*)(pLo + j), sum);
+            _mm256_storeu_si256((__m256i*)(pHi + j), mulAvx2(dif, w, mod, nInv));
+        }
+    }
+}
+
+/**
+ * inverseStageAvx2 - inverseStage eight butterflies at a time. len must be a multiple
+ * of 8.
+ */
+
+TARGET_AVX2
+static void inverseStageAvx2(const NTTPlan &plan, uint32_t* pData, uint32_t len)
+{
+    const uint32_t* pRoots  = &plan.invRoots[len];
+    __m256i mod             = _mm256_set1_epi32((int)plan.mod);
+    __m256i nInv            = _mm256_set1_epi32((int)plan.nInv);
+
+    for (uint32_t i = 0; i < plan.size; i += 2 * len)
+    {
+        uint32_t* pLo = pData + i;
+        uint32_t* pHi = pData + i + len;
+
+        for (uint32_t j = 0; j < len; j += 8)
+        {
+            __m256i u   = _mm256_loadu_si256((const __m256i*)(pLo + j));
+            __m256i w   = _mm256_loadu_si256((const __m256i*)(pRoots + j));
+            __m256i v   = mulAvx2(_mm256_loadu_si256((const __m256i*)(pHi + j)), w, mod, nInv);
+            __m256i sum = _mm256_add_epi32(u, v);
+            __m256i dif = _mm256_sub_epi32(u, v);
+
+            sum = _mm256_min_epu32(sum, _mm256_sub_epi32(sum, mod));
+            dif = _mm256_min_epu32(dif, _mm256_add_epi32(dif, mod));
+
+            _mm256_storeu_si256((__m256i*)(pLo + j), sum);
+            _mm256_storeu_si256((__m256i*)(pHi + j), dif);
+        }
+    }
+}
+
+/**
+ * NTTPlan::Forward - In-place forward transform, decimation in frequency. Stages with at
+ * least 8 butterflies per block run with AVX2 when the CPU has it. The last stage
+ * multiplies by w^0 = 1 only, so it's butterflies with no multiplies.
+ *
+ * @param pData Size values below mod, in natural order. Replaced with their transform in
+ * bit reversed order.
+ */
+
+void NTTPlan::Forward(uint32_t* pData) const
+{
+    static const bool hasAvx2 = cpuHasAvx2();
+
+    uint32_t len = size / 2;
+
+    if (hasAvx2)
+    {
+        for (; len >= 8; len >>= 1)
+        {
+            forwardStageAvx2(*this, pData, len);
+        }
+    }
+
+    for (; len > 1; len >>= 1)
+    {
+        forwardStage(*this, pData, len);
+    }
+
+    for (uint32_t i = 0; i + 1 < size; i += 2)
+    {
+        uint32_t u      = pData[i];
+        uint32_t v      = pData[i + 1];
+        pData[i]        = Add(u, v);
+        pData[i + 1]    = Sub(u, v);
+    }
+}
+
+/**
+ * NTTPlan::Inverse - In-place inverse transform, decimation in time, scaled by 1 / size
+ * so it undoes Forward.
+ *
+ * @param pData Size values below mod, in bit reversed order as Forward leaves them.
+ * Replaced with the inverse transform in natural order.
+ */
+
+void NTTPlan::Inverse(uint32_t* pData) const
+{
+    static const bool hasAvx2 = cpuHasAvx2();
+
+    for (uint32_t i = 0; i + 1 < size; i += 2)
+    {
+        uint32_t u      = pData[i];
+        uint32_t v      = pData[i + 1];
+        pData[i]        = Add(u, v);
+        pData[i + 1]    = Sub(u, v);
+    }
+
+    uint32_t len = 2;
+
+    for (; len < size && (len < 8 || !hasAvx2); len <<= 1)
+    {
+        inverseStage(*this, pData, len);
+    }
+
+    for (; len < size; len <<= 1)
+    {
+        inverseStageAvx2(*this, pData, len);
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        pData[i] = Mul(pData[i], scale);
+    }
+}
+
+/**
+ * NTTPlan::PointwiseMul - Multiply two transforms elementwise. A Montgomery product
+ * leaves a factor of 2^-32, which multiplying by R^2 mod p cancels, so the result is the
+ * plain product again.
+ *
+ * @param pA (in/out) First transform, replaced with the product. May be pB.
+ * @param pB Second transform.
+ */
+
+void NTTPlan::PointwiseMul(uint32_t* pA, const uint32_t* pB) const
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        pA[i] = Mul(Mul(pA[i], pB[i]), r2);
+    }
+}
+
+/**
+ * GetNTTPlan - Get a plan for one of the NTT primes and a size, building it on first
+ * use. Plans are cached per thread, like GetFFTPlan.
+ *
+ * @param mod  One of 998244353, 469762049 or 167772161.
+ * @param size Transform size. Must be a power of two the prime supports.
+ *
+ * @return Plan for that prime and size.
+ */
+
+const NTTPlan& GetNTTPlan(uint32_t mod, uint32_t size)
+{
+    thread_local map<uint64_t, NTTPlan> plans;
+
+    uint64_t key    = ((uint64_t)mod << 32) | size;
+    auto it         = plans.find(key);
+
+    if (it != plans.end())
+    {
+        return it->second;
+    }
+
+    uint32_t generator = 0;
+
+    for (uint32_t i = 0; i < numNttPrimes; i++)
+    {
+        if (nttPrimes[i].mod == mod)
+        {
+            generator = nttPrimes[i].generator;
+        }
+    }
+
+    assert(generator != 0);
+
+    NTTPlan &plan = plans[key];
+    plan.Init(mod, generator, size);
+
+    return plan;
+}
+
+/**
+ * convolvePrime - Convolve two sequences mod one NTT prime.
+ *
+ * @param a       First sequence.
+ * @param b       Second sequence. Squares a if it's the same vector.
+ * @param mod     NTT prime to work mod.
+ * @param nttSize Transform size, a power of two at least a.size() + b.size() - 1.
+ * @param res     (out) The a.size() + b.size() - 1 coefficients of a * b mod mod.
+ */
+
+static void convolvePrime(
+    const vector<uint64_t> &a,
+    const vector<uint64_t> &b,
+    uint32_t mod,
+    uint32_t nttSize,
+    vector<uint32_t> &res)
+{
+    const NTTPlan &plan = GetNTTPlan(mod, nttSize);
+
+    res.assign(nttSize, 0);
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        res[i] = (uint32_t)(a[i] % mod);
+    }
+
+    plan.Forward(res.data());
+
+    if (&a == &b)
+    {
+        plan.PointwiseMul(res.data(), res.data());
+    }
+    else
+    {
+        vector<uint32_t> fb(nttSize, 0);
+
+        for (size_t i = 0; i < b.size(); i++)
+        {
+            fb[i] = (uint32_t)(b[i] % mod);
+        }
+
+        plan.Forward(fb.data());
+        plan.PointwiseMul(res.data(), fb.data());
+    }
+
+    plan.Inverse(res.data());
+    res.resize(a.size() + b.size() - 1);
+}
+
+/**
+ * convolvePrimes - Convolve two sequences mod the first few NTT primes. The primes are
+ * independent, so big transforms run them in parallel.
+ *
+ * @param a         First sequence.
+ * @param b         Second sequence. Squares a if it's the same vector.
+ * @param numPrimes How many of the primes to use, 1 to 3.
+ * @param residues  (out) Coefficients of a * b mod each prime.
+ */
+
+static void convolvePrimes(
+    const vector<uint64_t> &a,
+    const vector<uint64_t> &b,
+    uint32_t numPrimes,
+    vector<uint32_t> residues[])
+{
+    size_t outSize      = a.size() + b.size() - 1;
+    uint32_t nttSize    = 1;
+
+    while (nttSize < outSize)
+    {
+        nttSize <<= 1;
+    }
+
+    assert(nttSize <= (1u << maxConvolveLog));
+
+    auto body = [&](uint64_t i)
+    {
+        convolvePrime(a, b, nttPrimes[i].mod, nttSize, residues[i]);
+    };
+
+    if (numPrimes > 1 && nttSize >= (1u << 15))
+    {
+        ParallelFor(0, numPrimes, body);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < numPrimes; i++)
+        {
+            body(i);
+        }
+    }
+}
+
+/**
+ * primesNeeded - Count how many NTT primes it takes for their product to exceed every
+ * coefficient of a * b, bounding those by min(a.size(), b.size()) * max(a) * max(b).
+ *
+ * @param a First sequence.
+ * @param b Second sequence.
+ *
+ * @return 1 to 3. Asserts if even all three primes can't hold the result.
+ */
+
+static uint32_t primesNeeded(const vector<uint64_t> &a, const vector<uint64_t> &b)
+{
+    uint64_t maxA = *max_element(a.begin(), a.end());
+    uint64_t maxB = *max_element(b.begin(), b.end());
+
+    // The bound is only approximate in double precision, so leave a little margin.
+
+    double bound    = 1.000001 * (double)min(a.size(), b.size()) * (double)maxA * (double)maxB;
+    double product  = 1.0;
+
+    for (uint32_t i = 0; i < numNttPrimes; i++)
+    {
+        product *= nttPrimes[i].mod;
+
+        if (bound < product)
+        {
+            return i + 1;
+        }
+    }
+
+    assert(!"convolve: coefficients too large for three primes");
+
+    return numNttPrimes;
+}
+
+/**
+ * crtConstants - Constants to recombine residues mod the three NTT primes p1, p2, p3 as
+ * x = r1 + p1 * t2 + p1 * p2 * t3, Garner's mixed radix form.
+ *
+ * @param inv12  (out) p1^-1 mod p2.
+ * @param inv123 (out) (p1 * p2)^-1 mod p3.
+ */
+
+static void crtConstants(uint64_t &inv12, uint64_t &inv123)
+{
+    uint64_t p1 = nttPrimes[0].mod;
+    uint64_t p2 = nttPrimes[1].mod;
+    uint64_t p3 = nttPrimes[2].mod;
+
+    inv12   = inverseMod64(p1 % p2, p2);
+    inv123  = inverseMod64(p1 * p2 % p3, p3);
+}
+
+/**
+ * convolveSchoolbook - Convolve directly in O(len(a) * len(b)), which beats three
+ * transforms when either sequence is short.
+ *
+ * @param a   First sequence.
+ * @param b   Second sequence.
+ * @param mod Modulus below 2^32, or 0 to wrap mod 2^64.
+ * @param out (out) Coefficients of a * b.
+ */
+
+static void convolveSchoolbook(
+    const vector<uint64_t> &a,
+    const vector<uint64_t> &b,
+    uint64_t mod,
+    vector<uint64_t> &out)
+{
+    out.assign(a.size() + b.size() - 1, 0);
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        for (size_t j = 0; j < b.size(); j++)
+        {
+            if (mod == 0)
+            {
+                out[i + j] += a[i] * b[j];
+            }
+            else
+            {
+                out[i + j] = (out[i + j] + (a[i] % mod) * (b[j] % mod) % mod) % mod;
+            }
+        }
+    }
+}
+
+/**
+ * convolve - Multiply two polynomials with 64-bit coefficients exactly, in
+ * O(n log n). The product is computed mod as many NTT primes as its coefficients
+ * need, up to three, and rebuilt with the CRT. Coefficients must stay below the product
+ * of the three primes, about 7.9e25; above 2^64, they come back mod 2^64.
+ *
+ * @param a   Coefficients of the first polynomial, lowest degree first.
+ * @param b   Coefficients of the second. Pass a again to square it with one fewer
+ *            transform.
+ * @param out (out) The a.size() + b.size() - 1 coefficients of a * b, or none if either
+ *            input is empty.
+ */
+
+void convolve(const vector<uint64_t> &a, const vector<uint64_t> &b, vector<uint64_t> &out)
+{
+    if (a.empty() || b.empty())
+    {
+        out.clear();
+        return;
+    }
+
+    if (min(a.size(), b.size()) <= schoolbookMaxLen)
+    {
+        convolveSchoolbook(a, b, 0, out);
+        return;
+    }
+
+    uint32_t numPrimes = primesNeeded(a, b);
+    vector<uint32_t> residues[numNttPrimes];
+
+    convolvePrimes(a, b, numPrimes, residues);
+
+    uint64_t inv12;
+    uint64_t inv123;
+    crtConstants(inv12, inv123);
+
+    uint64_t p1 = nttPrimes[0].mod;
+    uint64_t p2 = nttPrimes[1].mod;
+    uint64_t p3 = nttPrimes[2].mod;
+
+    out.resize(residues[0].size());
+
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        uint64_t x = residues[0][i];
+
+        if (numPrimes > 1)
+        {
+            uint64_t t2 = (residues[1][i] + p2 - x % p2) * inv12 % p2;
+            x += p1 * t2;
+        }
+
+        if (numPrimes > 2)
+        {
+            uint64_t t3 = (residues[2][i] + p3 - x % p3) * inv123 % p3;
+            x += p1 * p2 * t3;
+        }
+
+        out[i] = x;
+    }
+}
+
+/**
+ * convolveMod - Multiply two polynomials mod m in O(n log n). Mod one of the NTT primes
+ * it's a single transform. Otherwise the exact product is found mod all three primes
+ * and reduced, which works while len * (m - 1)^2 stays below their product, e.g., for
+ * m near 10^9 and inputs up to about 7.9e7 long.
+ *
+ * @param a   Coefficients of the first polynomial, lowest degree first.
+ * @param b   Coefficients of the second. Pass a again to square it.
+ * @param mod Modulus.
+ * @param out (out) The a.size() + b.size() - 1 coefficients of a * b mod m.
+ */
+
+void convolveMod(const vector<uint64_t> &a, const vector<uint64_t> &b, uint32_t mod, vector<uint64_t> &out)
+{
+    assert(mod > 0);
+
+    if (a.empty() || b.empty())
+    {
+        out.clear();
+        return;
+    }
+
+    if (min(a.size(), b.size()) <= schoolbookMaxLen)
+    {
+        convolveSchoolbook(a, b, mod, out);
+        return;
+    }
+
+    for (uint32_t i = 0; i < numNttPrimes; i++)
+    {
+        if (nttPrimes[i].mod != mod)
+        {
+            continue;
+        }
+
+        vector<uint32_t> res;
+        uint32_t nttSize = 1;
+
+        while (nttSize < a.size() + b.size() - 1)
+        {
+            nttSize <<= 1;
+        }
+
+        assert(nttSize <= (1u << nttPrimes[i].maxLog));
+
+        convolvePrime(a, b, mod, nttSize, res);
+        out.assign(res.begin(), res.end());
+
+        return;
+    }
+
+    // The primes need the exact product, so reduce the inputs first.
+
+    vector<uint64_t> aMod(a.size());
+    vector<uint64_t> bMod(b.size());
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        aMod[i] = a[i] % mod;
+    }
+
+    for (size_t i = 0; i < b.size(); i++)
+    {
+        bMod[i] = b[i] % mod;
+    }
+
+    const vector<uint64_t> &bIn = (&a == &b) ? aMod : bMod;
+    uint32_t numPrimes          = primesNeeded(aMod, bIn);
+    vector<uint32_t> residues[numNttPrimes];
+
+    convolvePrimes(aMod, bIn, numPrimes, residues);
+
+    uint64_t inv12;
+    uint64_t inv123;
+    crtConstants(inv12, inv123);
+
+    uint64_t p1     = nttPrimes[0].mod;
+    uint64_t p2     = nttPrimes[1].mod;
+    uint64_t p3     = nttPrimes[2].mod;
+    uint64_t p1Mod  = p1 % mod;
+    uint64_t p12Mod = p1 * p2 % mod;
+
+    out.resize(residues[0].size());
+
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        uint64_t x12    = residues[0][i];
+        uint64_t x      = x12 % mod;
+
+        if (numPrimes > 1)
+        {
+            uint64_t t2 = (residues[1][i] + p2 - x12 % p2) * inv12 % p2;
+            x12         += p1 * t2;
+            x           = (x + p1Mod * t2) % mod;
+        }
+
+        if (numPrimes > 2)
+        {
+            uint64_t t3 = (residues[2][i] + p3 - x12 % p3) * inv123 % p3;
+            x           = (x + p12Mod * t3) % mod;
+        }
+
+        out[i] = x;
+    }
+}
+
+/**
+ * randomVector - Fill a vector with random values below a limit.
+ *
+ * @param len   Number of values.
+ * @param limit Exclusive upper bound, up to 2^64 - 1.
+ * @param vals  (out) Random values.
+ */
+
+static void randomVector(size_t len, uint64_t limit, vector<uint64_t> &vals)
+{
+    vals.resize(len);
+
+    for (auto& val : vals)
+    {
+        uint64_t r = ((uint64_t)rand() << 48) ^ ((uint64_t)rand() << 32) ^ ((uint64_t)rand() << 16) ^ rand();
+        val = r % limit;
+    }
+}
+
+/**
+ * TestNTT - Check NTT convolutions against schoolbook multiplication, over and under the
+ * schoolbook cutoff, for coefficients needing one, two and three primes, mod a general
+ * modulus and an NTT prime, and squaring. Then time them against schoolbook.
+ */
+
+void TestNTT()
+{
+    // Round trips through one plan.
+
+    uint32_t roundTripFails = 0;
+
+    for (uint32_t n = 1; n <= (1 << 12); n <<= 1)
+    {
+        const NTTPlan &plan = GetNTTPlan(998244353, n);
+        vector<uint64_t> input;
+        randomVector(n, 998244353, input);
+
+        vector<uint32_t> data(input.begin(), input.end());
+        plan.Forward(data.data());
+        plan.Inverse(data.data());
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            roundTripFails += (data[i] != input[i]);
+        }
+    }
+
+    printf("NTT round trip mismatches, sizes 1 to 4096: %u\n", roundTripFails);
+
+    // Products against schoolbook.
+
+    const size_t lens[][2]      = { { 1, 1 }, { 5, 200 }, { 33, 33 }, { 100, 1000 }, { 777, 1500 }, { 3000, 3000 } };
+    const uint64_t limits[]     = { 1000, 1ull << 20, 1ull << 32, 1ull << 40 };
+    const uint32_t mods[]       = { 1000000007, 998244353, 1000000 };
+    uint32_t fails              = 0;
+    uint32_t checks             = 0;
+
+    for (auto& len : lens)
+    {
+        for (uint64_t limit : limits)
+        {
+            vector<uint64_t> a;
+            vector<uint64_t> b;
+            vector<uint64_t> fast;
+            vector<uint64_t> slow;
+
+            randomVector(len[0], limit, a);
+            randomVector(len[1], limit, b);
+
+            if ((double)min(len[0], len[1]) * limit * limit < 7.8e25)
+            {
+                convolve(a, b, fast);
+                convolveSchoolbook(a, b, 0, slow);
+                fails += (fast != slow);
+
+                convolve(a, a, fast);
+                convolveSchoolbook(a, a, 0, slow);
+                fails += (fast != slow);
+
+                checks += 2;
+            }
+
+            for (uint32_t mod : mods)
+            {
+                convolveMod(a, b, mod, fast);
+                convolveSchoolbook(a, b, mod, slow);
+                fails += (fast != slow);
+
+                convolveMod(b, b, mod, fast);
+                convolveSchoolbook(b, b, mod, slow);
+                fails += (fast != slow);
+
+                checks += 2;
+            }
+        }
+    }
+
+    printf("Convolution mismatches against schoolbook: %u of %u\n", fails, checks);
+
+    // Timing. Schoolbook at 2^14 terms each, then the transforms up to 2^21, where the
+    // product is 2^22 long.
+
+    vector<uint64_t> a;
+    vector<uint64_t> b;
+    vector<uint64_t> out;
+
+    randomVector(1 << 14, 1000000007, a);
+    randomVector(1 << 14, 1000000007, b);
+
+    printBenchStats(runBenchmark("2^14 schoolbook mod 1e9+7", [&]()
+    {
+        convolveSchoolbook(a, b, 1000000007, out);
+    }));
+
+    for (uint32_t logSize = 14; logSize <= 21; logSize += 7)
+    {
+        char name[64];
+
+        randomVector((size_t)1 << logSize, 1000000007, a);
+        randomVector((size_t)1 << logSize, 1000000007, b);
+
+        snprintf(name, sizeof(name), "2^%u mod 998244353", logSize);
+        printBenchStats(runBenchmark(name, [&]() { convolveMod(a, b, 998244353, out); }));
+
+        snprintf(name, sizeof(name), "2^%u mod 1e9+7", logSize);
+        printBenchStats(runBenchmark(name, [&]() { convolveMod(a, b, 1000000007, out); }));
+
+        snprintf(name, sizeof(name), "2^%u exact", logSize);
+        printBenchStats(runBenchmark(name, [&]() { convolve(a, b, out); }));
+    }
+}
\ No newline at end of file
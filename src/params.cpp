@@ -0,0 +1,239 @@
+#include "params.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+/**
+ * parseNumber - Parse a whole string as a number, plain or in scientific notation.
+ *
+ * @param pText Text to parse.
+ * @param value (out) Parsed value.
+ *
+ * @return True if the whole string was a finite number.
+ */
+
+bool parseNumber(const char* pText, double &value)
+{
+    char* pEnd;
+
+    if (*pText == 0)
+    {
+        return false;
+    }
+
+    value = strtod(pText, &pEnd);
+
+    return *pEnd == 0 && isfinite(value);
+}
+
+/**
+ * ParamSet::Find - Look up a parameter by name.
+ *
+ * @param name Parameter name.
+ *
+ * @return The parameter, or null if there's none by that name.
+ */
+
+Param* ParamSet::Find(const string &name)
+{
+    for (auto& param : params)
+    {
+        if (param.name == name)
+        {
+            return &param;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * ParamSet::Set - Set a parameter from text. Integer fields given as plain digits are
+ * parsed exactly, so values past 2^53 survive, and anything past 2^64 - 1 is rejected
+ * rather than clamped.
+ *
+ * @param name Parameter name.
+ * @param text New value.
+ *
+ * @return False if there's no such parameter or the value doesn't fit its type. The
+ * field is left alone in that case.
+ */
+
+bool ParamSet::Set(const string &name, const string &text)
+{
+    Param* pParam = Find(name);
+
+    if (!pParam)
+    {
+        return false;
+    }
+
+    if (pParam->type != PARAM_DOUBLE && !text.empty() &&
+        text.find_first_not_of("0123456789") == string::npos)
+    {
+        char* pEnd;
+
+        errno = 0;
+        unsigned long long value = strtoull(text.c_str(), &pEnd, 10);
+
+        if (errno == ERANGE || value < pParam->minValue ||
+            (pParam->type == PARAM_U32 && value > UINT32_MAX))
+        {
+            return false;
+        }
+
+        if (pParam->type == PARAM_U32)
+        {
+            *(uint32_t*)pParam->pValue = (uint32_t)value;
+        }
+        else
+        {
+            *(uint64_t*)pParam->pValue = (uint64_t)value;
+        }
+
+        return true;
+    }
+
+    double value;
+
+    if (!parseNumber(text.c_str(), value))
+    {
+        return false;
+    }
+
+    return Set(name, value);
+}
+
+/**
+ * ParamSet::Set - Set a parameter from a number.
+ *
+ * @param name  Parameter name.
+ * @param value New value. Must be a whole number in range, and at least the field's
+ *              minimum, for integer fields.
+ *
+ * @return False if there's no such parameter or the value doesn't fit its type.
+ */
+
+bool ParamSet::Set(const string &name, double value)
+{
+    Param* pParam = Find(name);
+
+    if (!pParam)
+    {
+        return false;
+    }
+
+    if (pParam->type == PARAM_DOUBLE)
+    {
+        *(double*)pParam->pValue = value;
+        return true;
+    }
+
+    double limit = (pParam->type == PARAM_U32) ? 4294967296.0 : 18446744073709551616.0;
+
+    if (value < (double)pParam->minValue || value >= limit || value != floor(value))
+    {
+        return false;
+    }
+
+    if (pParam->type == PARAM_U32)
+    {
+        *(uint32_t*)pParam->pValue = (uint32_t)value;
+    }
+    else
+    {
+        *(uint64_t*)pParam->pValue = (uint64_t)value;
+    }
+
+    return true;
+}
+
+/**
+ * ParamSet::Get - Read a parameter as a double.
+ *
+ * @param name Parameter name.
+ *
+ * @return Current value, or NaN if there's no such parameter.
+ */
+
+double ParamSet::Get(const string &name) const
+{
+    for (auto& param : params)
+    {
+        if (param.name != name)
+        {
+            continue;
+        }
+
+        switch (param.type)
+        {
+        case PARAM_U32:
+            return (double)*(const uint32_t*)param.pValue;
+        case PARAM_U64:
+            return (double)*(const uint64_t*)param.pValue;
+        default:
+            return *(const double*)param.pValue;
+        }
+    }
+
+    return NAN;
+}
+
+/**
+ * ParamSet::ParseArg - Apply a "--name=value" command line argument if it names one of
+ * the parameters.
+ *
+ * @param arg    Argument to parse.
+ * @param bValid (out) If the argument was a parameter, whether its value was accepted.
+ *
+ * @return True if the argument names a parameter in this set.
+ */
+
+bool ParamSet::ParseArg(const string &arg, bool &bValid)
+{
+    size_t eq = arg.find('=');
+
+    if (arg.compare(0, 2, "--") != 0 || eq == string::npos || !Find(arg.substr(2, eq - 2)))
+    {
+        return false;
+    }
+
+    bValid = Set(arg.substr(2, eq - 2), arg.substr(eq + 1));
+
+    return true;
+}
+
+/**
+ * ParamSet::ToString - Format every parameter as "name=value", space separated, in the
+ * order they were added.
+ *
+ * @return Formatted parameters.
+ */
+
+string ParamSet::ToString() const
+{
+    string out;
+    char buf[64];
+
+    for (auto& param : params)
+    {
+        switch (param.type)
+        {
+        case PARAM_U32:
+            snprintf(buf, sizeof(buf), "%u", *(const uint32_t*)param.pValue);
+            break;
+        case PARAM_U64:
+            snprintf(buf, sizeof(buf), "%llu", (unsigned long long)*(const uint64_t*)param.pValue);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "%g", *(const double*)param.pValue);
+            break;
+        }
+
+        out += (out.empty() ? "" : " ") + param.name + "=" + buf;
+    }
+
+    return out;
+}
\ No newline at end of file
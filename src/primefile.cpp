@@ -0,0 +1,316 @@
+#include "primefile.h"
+#include "primes.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * PrimeFile::Open - Map a binary prime table into memory and check its header.
+ *
+ * @param fileName Name of the file to open.
+ *
+ * @return True if the file was mapped and looks like a valid prime table.
+ */
+
+bool PrimeFile::Open(const char* fileName)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    hFile = file;
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(PrimeFileHeader))
+    {
+        Close();
+        return false;
+    }
+
+    size        = (size_t)fileSize.QuadPart;
+    hMapping    = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (hMapping == NULL)
+    {
+        Close();
+        return false;
+    }
+
+    pBase = (const uint8_t*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd = open(fileName, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(PrimeFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    size        = (size_t)fileStat.st_size;
+    void* pMap  = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    pBase = (pMap == MAP_FAILED) ? nullptr : (const uint8_t*)pMap;
+#endif
+
+    if (pBase == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    const PrimeFileHeader* pHdr = (const PrimeFileHeader*)pBase;
+
+    uint64_t numBlocks  = (pHdr->count + primeFileBlockSize - 1) / primeFileBlockSize;
+    uint64_t tableBytes = sizeof(PrimeFileHeader) + numBlocks * sizeof(PrimeFileCheckpoint);
+
+    if (pHdr->magic != primeFileMagic ||
+        pHdr->version != primeFileVersion ||
+        pHdr->blockSize != primeFileBlockSize ||
+        pHdr->numBlocks != numBlocks ||
+        tableBytes + pHdr->gapBytes > size)
+    {
+        Close();
+        return false;
+    }
+
+    pHeader         = pHdr;
+    pCheckpoints    = (const PrimeFileCheckpoint*)(pBase + sizeof(PrimeFileHeader));
+    pGaps           = pBase + tableBytes;
+
+    return true;
+}
+
+/**
+ * PrimeFile::Close - Unmap the file, if one is open.
+ */
+
+void PrimeFile::Close()
+{
+#ifdef _WIN32
+    if (pBase)
+    {
+        UnmapViewOfFile(pBase);
+    }
+
+    if (hMapping)
+    {
+        CloseHandle((HANDLE)hMapping);
+    }
+
+    if (hFile)
+    {
+        CloseHandle((HANDLE)hFile);
+    }
+#else
+    if (pBase)
+    {
+        munmap((void*)pBase, size);
+    }
+#endif
+
+    pBase           = nullptr;
+    size            = 0;
+    hFile           = nullptr;
+    hMapping        = nullptr;
+    pHeader         = nullptr;
+    pCheckpoints    = nullptr;
+    pGaps           = nullptr;
+}
+
+/**
+ * PrimeFile::LowerBound - Find the first prime in the file no smaller than x.
+ *
+ * @param x     Value to search for.
+ * @param index (out) Position of that prime in the file, i.e., how many primes in the
+ * file are smaller than x. Count() if there's no such prime.
+ *
+ * @return First prime >= x, or 0 if every prime in the file is smaller than x.
+ */
+
+uint64_t PrimeFile::LowerBound(uint64_t x, uint64_t &index) const
+{
+    index = Count();
+
+    if (Count() == 0 || x > MaxPrime())
+    {
+        return 0;
+    }
+
+    // The answer is in x's block, or else it's the first prime of the next one.
+
+    uint32_t block  = FindBlock(x);
+    uint64_t pos    = (uint64_t)block * pHeader->blockSize;
+    uint64_t found  = 0;
+    uint64_t last   = (block + 1 < pHeader->numBlocks) ? pCheckpoints[block + 1].prime : MaxPrime();
+
+    ForEachPrime(pCheckpoints[block].prime, last, [&](uint64_t p)
+    {
+        if (found == 0)
+        {
+            if (p >= x)
+            {
+                found = p;
+            }
+            else
+            {
+                pos++;
+            }
+        }
+    });
+
+    index = pos;
+    return found;
+}
+
+/**
+ * writePrimesToFile - Write computed primes to a binary prime table (see primefile.h).
+ *
+ * @param fileName Name of output file.
+ * @param primes List of primes to write to file, in increasing order.
+ *
+ * @return True if the file was written.
+ */
+
+bool writePrimesToFile(const char* fileName, const vector<uint32_t> &primes)
+{
+    PrimeFileHeader header;
+    vector<PrimeFileCheckpoint> checkpoints;
+    vector<uint8_t> gaps;
+
+    gaps.reserve(primes.size() + 16);
+    checkpoints.reserve(primes.size() / primeFileBlockSize + 1);
+
+    for (size_t i = 0; i < primes.size(); i++)
+    {
+        if (i % primeFileBlockSize == 0)
+        {
+            checkpoints.push_back({ primes[i], (uint64_t)gaps.size() });
+            continue;
+        }
+
+        assert(primes[i] > primes[i - 1]);
+
+        uint32_t gap        = primes[i] - primes[i - 1];
+        uint32_t halfGap    = (gap == 1) ? 1 : gap / 2;
+
+        assert(halfGap <= 0xFFFF);
+
+        if (halfGap < 256)
+        {
+            gaps.push_back((uint8_t)halfGap);
+        }
+        else
+        {
+            gaps.push_back(0);
+            gaps.push_back((uint8_t)(halfGap & 0xFF));
+            gaps.push_back((uint8_t)(halfGap >> 8));
+        }
+    }
+
+    header.magic        = primeFileMagic;
+    header.version      = primeFileVersion;
+    header.count        = primes.size();
+    header.maxPrime     = primes.size() ? primes.back() : 0;
+    header.blockSize    = primeFileBlockSize;
+    header.numBlocks    = (uint32_t)checkpoints.size();
+    header.gapBytes     = gaps.size();
+
+    ofstream primeFile(fileName, ios::out | ios::binary | ios::trunc);
+
+    if (!primeFile)
+    {
+        return false;
+    }
+
+    primeFile.write((const char*)&header, sizeof(header));
+    primeFile.write((const char*)checkpoints.data(), checkpoints.size() * sizeof(PrimeFileCheckpoint));
+    primeFile.write((const char*)gaps.data(), gaps.size());
+    primeFile.close();
+
+    return !primeFile.fail();
+}
+
+/**
+ * readPrimesFromFile - Read primes from a binary prime table.
+ *
+ * @param fileName Name of input file.
+ * @param primes List of primes to populate from file.
+ * @param max Read in all primes less than or equal to this max value. If zero,
+ * read all primes from file.
+ *
+ * @return True if the file could be opened and read.
+ */
+
+bool readPrimesFromFile(const char* fileName, vector<uint32_t> &primes, uint32_t max)
+{
+    PrimeFile file;
+    primes.clear();
+
+    if (!file.Open(fileName))
+    {
+        return false;
+    }
+
+    uint64_t maxRead = (max == 0) ? UINT64_MAX : max;
+    uint64_t numPrimes;
+
+    file.LowerBound(maxRead == UINT64_MAX ? maxRead : maxRead + 1, numPrimes);
+    primes.reserve((size_t)numPrimes);
+
+    file.ForEachPrime(0, maxRead, [&](uint64_t p) { primes.push_back((uint32_t)p); });
+
+    return true;
+}
+
+/**
+ * readPrimesFromFile - Same as above, but read primes into a hash table.
+ *
+ * @param fileName Name of input file.
+ * @param primes List of primes to populate from file.
+ * @param max Read in all primes less than or equal to this max value. If zero,
+ * read all primes from file.
+ *
+ * @return True if the file could be opened and read.
+ */
+
+bool readPrimesFromFile(const char* fileName, unordered_set<uint32_t> &primes, uint32_t max)
+{
+    PrimeFile file;
+    primes.clear();
+
+    if (!file.Open(fileName))
+    {
+        return false;
+    }
+
+    uint64_t maxRead = (max == 0) ? UINT64_MAX : max;
+    uint64_t numPrimes;
+
+    file.LowerBound(maxRead == UINT64_MAX ? maxRead : maxRead + 1, numPrimes);
+    primes.reserve((size_t)numPrimes);
+
+    file.ForEachPrime(0, maxRead, [&](uint64_t p) { primes.insert((uint32_t)p); });
+
+    return true;
+}
\ No newline at end of file
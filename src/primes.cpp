@@ -1,450 +1,1784 @@
 #include "primes.h"
+#include "threadpool.h"
+#include "modarith.h"
+#include <random>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 /**
- * primeSieve - Generate a list of prime numbers up to a maximum value.
- * Use a simple sieve: mark off multiples starting at 2, and whatever's
- * left is prime.
+ * isqrt - Integer square root, floor(sqrt(n)). Start from the double precision
+ * estimate and nudge it until it's exact.
+ *
+ * @param n Value to take square root of.
+ *
+ * @return Largest r such that r * r <= n.
+ */
+
+static uint64_t isqrt(uint64_t n)
+{
+    uint64_t r = (uint64_t)sqrt((double)n);
+
+    while (r > 0xFFFFFFFF || r * r > n)
+    {
+        r--;
+    }
+
+    while (r < 0xFFFFFFFF && (r + 1) * (r + 1) <= n)
+    {
+        r++;
+    }
+
+    return r;
+}
+
+/**
+ * primeCountBound - Upper bound on the number of primes up to x (Rosser and
+ * Schoenfeld, pi(x) < 1.25506 x / ln x). Used to reserve output buffers.
+ *
+ * @param x Bound the number of primes up to this value.
+ *
+ * @return Value at least as large as pi(x).
+ */
+
+static size_t primeCountBound(uint64_t x)
+{
+    if (x < 17)
+    {
+        return 6;
+    }
+
+    return (size_t)(1.25506 * (double)x / log((double)x)) + 1;
+}
+
+/**
+ * basePrimeSieve - Sieve for the list of primes needed to sieve a larger range, i.e.,
+ * primes up to sqrt of the real sieve limit. Small limits use a simple odd-only sieve.
+ * Past 2^24 (ranges above ~2.8e14), use the segmented sieve instead so the scratch
+ * space doesn't grow with the limit. Its own base primes are at most 2^16, so this
+ * only recurses once.
  *
  * @param max Generate all prime numbers up to this value.
  * @param primes (out) A list of all the primes found.
  */
 
-void primeSieve(uint32_t max, vector<uint32_t> &primes)
+static void basePrimeSieve(uint32_t max, vector<uint32_t> &primes)
 {
-    vector<uint32_t> scratch;
-    assert(max / 2 < scratch.max_size());
-    scratch.resize(max + 1, 0);
+    primes.clear();
 
-    scratch[0] = 1;
-    scratch[1] = 1;
+    if (max < 2)
+    {
+        return;
+    }
 
-	uint32_t primeCnt = 0;
+    if (max > (1 << 24))
+    {
+        primes.reserve(primeCountBound(max));
 
-    // Starting at 2, loop through multiples of numbers and mark 
-    // them as composite.
+        SegmentedSieve sieve;
+        sieve.Init(0, max);
 
-	for (uint32_t i = 2; i <= max / 2; i++)
-	{
-        if (scratch[i] == 1)
+        while (sieve.NextSegment())
         {
-            continue;
+            sieve.ForEachPrime([&](uint64_t p) { primes.push_back((uint32_t)p); });
         }
 
-		uint32_t factor = 2 * i;
-		while (factor <= max)
-		{
-			scratch[factor] = 1;
-			factor += i;
-		}
-	}
+        return;
+    }
 
-    // Count how many primes are left over.
+    primes.push_back(2);
 
-	for (uint32_t i = 1; i <= max; i++)
-	{
-        if (scratch[i] == 0)
+    // scratch[i] flags the odd value 2i + 1.
+
+    vector<uint8_t> scratch(max / 2 + 1, 0);
+
+    for (uint64_t i = 3; i * i <= max; i += 2)
+    {
+        if (scratch[i / 2])
         {
-            primeCnt++;
+            continue;
         }
-	}
 
-    // Put them in the output vector and done.
-
-    primes.resize(primeCnt);
+        for (uint64_t j = i * i; j <= max; j += 2 * i)
+        {
+            scratch[j / 2] = 1;
+        }
+    }
 
-	for (uint32_t i = 1, j = 0; i <= max; i++)
-	{
-        if (scratch[i] == 0)
+    for (uint64_t i = 3; i <= max; i += 2)
+    {
+        if (scratch[i / 2] == 0)
         {
-            primes[j++] = i;
+            primes.push_back((uint32_t)i);
         }
-	}
+    }
 }
 
-/**
- * primeSieve - Prime sieve, 64-bit version.
- * 
- * @param max Generate all prime numbers up to this value.
- * @param primes (out) A list of all the primes found.
- */
+// Wheel stepping tables. Multiples p * k of a sieving prime are only crossed off for
+// k coprime to 30, so k walks the wheel residues with gaps wheelGap[i]. For a prime
+// whose residue has wheel index a, wheelClear[a][i] clears the bit of p * k when k is at
+// wheel index i, and wheelCarry[a][i] is the byte carry when stepping k to index i + 1.
+// The full byte step is (p / 30) * wheelGap[i] + wheelCarry[a][i].
 
-void primeSieve(uint64_t max, vector<uint64_t> &primes)
+static const uint8_t wheelGap[8] = { 6, 4, 2, 4, 2, 4, 6, 2 };
+
+static const uint8_t wheelClear[8][8] =
 {
-    vector<uint64_t> scratch;
-    assert(max / 2 < scratch.max_size());
-    scratch.resize(max + 1, 0);
+    { 0xFE, 0xFD, 0xFB, 0xF7, 0xEF, 0xDF, 0xBF, 0x7F },
+    { 0xFD, 0xDF, 0xEF, 0xFE, 0x7F, 0xF7, 0xFB, 0xBF },
+    { 0xFB, 0xEF, 0xFE, 0xBF, 0xFD, 0x7F, 0xF7, 0xDF },
+    { 0xF7, 0xFE, 0xBF, 0xDF, 0xFB, 0xFD, 0x7F, 0xEF },
+    { 0xEF, 0x7F, 0xFD, 0xFB, 0xDF, 0xBF, 0xFE, 0xF7 },
+    { 0xDF, 0xF7, 0x7F, 0xFD, 0xBF, 0xFE, 0xEF, 0xFB },
+    { 0xBF, 0xFB, 0xF7, 0x7F, 0xFE, 0xEF, 0xDF, 0xFD },
+    { 0x7F, 0xBF, 0xDF, 0xEF, 0xF7, 0xFB, 0xFD, 0xFE }
+};
+
+static const uint8_t wheelCarry[8][8] =
+{
+    { 0, 0, 0, 0, 0, 0, 0, 1 },
+    { 1, 1, 1, 0, 1, 1, 1, 1 },
+    { 2, 2, 0, 2, 0, 2, 2, 1 },
+    { 3, 1, 1, 2, 1, 1, 3, 1 },
+    { 3, 3, 1, 2, 1, 3, 3, 1 },
+    { 4, 2, 2, 2, 2, 2, 4, 1 },
+    { 5, 3, 1, 4, 1, 3, 5, 1 },
+    { 6, 4, 2, 4, 2, 4, 6, 1 }
+};
+
+// Pre-sieve groups. On the wheel, multiples of a prime p repeat every p bytes, so the
+// multiples of a group of primes repeat every (product of the group) bytes. Each
+// segment starts as a copy of the first group's pattern and gets the rest ANDed in, so
+// primes up to presieveMax never go through the marking loop. Periods are kept to a few
+// KB so the patterns stay in L1 next to the segment. Short groups are padded with 1s.
+
+static const uint32_t presieveMax       = 47;
+static const uint32_t presieveNumGroups = 5;
+
+static const uint32_t presieveGroups[presieveNumGroups][3] =
+{
+    { 7, 11, 13 },
+    { 17, 19, 23 },
+    { 29, 31, 1 },
+    { 37, 41, 1 },
+    { 43, 47, 1 }
+};
 
-    scratch[0] = 1;
-    scratch[1] = 1;
+static const uint32_t presievePrimes[] = { 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47 };
 
-    uint64_t primeCnt = 0;
+struct PresievePattern
+{
+    uint32_t period;
+    vector<uint8_t> bytes;
+};
 
-    // Starting at 2, loop through multiples of numbers and mark 
-    // them as composite.
+/**
+ * getPresievePatterns - Build the pre-sieve pattern for each group on first use. Each
+ * is stored twice over, so a run of up to one period can be read from any phase.
+ *
+ * @return Pre-sieve patterns, one per group.
+ */
 
-    for (uint64_t i = 2; i <= max / 2; i++)
+static const vector<PresievePattern>& getPresievePatterns()
+{
+    static const vector<PresievePattern> patterns = []()
     {
-        if (scratch[i] == 1)
-        {
-            continue;
-        }
+        vector<PresievePattern> out(presieveNumGroups);
 
-        uint64_t factor = 2 * i;
-        while (factor <= max)
+        for (uint32_t g = 0; g < presieveNumGroups; g++)
         {
-            scratch[factor] = 1;
-            factor += i;
+            uint32_t period = 1;
+
+            for (uint32_t p : presieveGroups[g])
+            {
+                period *= p;
+            }
+
+            out[g].period = period;
+            out[g].bytes.assign(2 * (size_t)period, 0xFF);
+
+            for (uint32_t p : presieveGroups[g])
+            {
+                if (p == 1)
+                {
+                    continue;
+                }
+
+                for (uint64_t v = p; v < 60 * (uint64_t)period; v += p)
+                {
+                    uint8_t bit = wheel30BitIndex[v % 30];
+
+                    if (bit != 0xFF)
+                    {
+                        out[g].bytes[(size_t)(v / 30)] &= ~(1 << bit);
+                    }
+                }
+            }
         }
+
+        return out;
+    }();
+
+    return patterns;
+}
+
+/**
+ * andBytes - AND one byte array into another, 32 bytes at a time with AVX2 if it's
+ * available, else 8 bytes at a time.
+ *
+ * @param pDst Bytes to AND into.
+ * @param pSrc Bytes to AND with.
+ * @param n    Number of bytes.
+ */
+
+static void andBytes(uint8_t* pDst, const uint8_t* pSrc, size_t n)
+{
+    size_t i = 0;
+
+#ifdef __AVX2__
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(pDst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+        _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_and_si256(a, b));
     }
+#endif
+
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t a;
+        uint64_t b;
 
-    // Count how many primes are left over.
+        memcpy(&a, pDst + i, sizeof(a));
+        memcpy(&b, pSrc + i, sizeof(b));
+        a &= b;
+        memcpy(pDst + i, &a, sizeof(a));
+    }
 
-    for (uint64_t i = 1; i <= max; i++)
+    for (; i < n; i++)
     {
-        if (scratch[i] == 0)
-        {
-            primeCnt++;
-        }
+        pDst[i] &= pSrc[i];
     }
+}
 
-    // Put them in the output vector and done.
+/**
+ * presieve - Fill a segment with the pre-sieve patterns, starting from wheel byte low.
+ * This clears the pre-sieved primes themselves too, so the caller has to restore them.
+ *
+ * @param pBytes   Segment to fill.
+ * @param low      Wheel byte index of the start of the segment.
+ * @param numBytes Segment length in bytes.
+ */
 
-    primes.resize(primeCnt);
+static void presieve(uint8_t* pBytes, uint64_t low, size_t numBytes)
+{
+    const vector<PresievePattern> &patterns = getPresievePatterns();
 
-    for (uint64_t i = 1, j = 0; i <= max; i++)
+    for (uint32_t g = 0; g < presieveNumGroups; g++)
     {
-        if (scratch[i] == 0)
+        const PresievePattern &pattern = patterns[g];
+        const uint8_t* pSrc = pattern.bytes.data() + (size_t)(low % pattern.period);
+
+        for (size_t i = 0; i < numBytes; i += pattern.period)
         {
-            primes[j++] = i;
+            size_t len = (numBytes - i < pattern.period) ? numBytes - i : pattern.period;
+
+            if (g == 0)
+            {
+                memcpy(pBytes + i, pSrc, len);
+            }
+            else
+            {
+                andBytes(pBytes + i, pSrc, len);
+            }
         }
     }
 }
 
 /**
- * primeSieve - Use sieving to generate a list of primes betwee
- * a min and max value, inclusive.
+ * SegmentedSieve::Init - Set up a segmented sieve over [min, max]. Sieve the primes
+ * up to sqrt(max) and hand off to the Init below.
  *
- * @param min Generate primes including and above this value.
- * @param max Generate all prime numbers up to and including this value.
- * @param primes (out) A list of all the primes found.
+ * @param minIn Smallest value to report primes for.
+ * @param maxIn Largest value to report primes for.
  */
 
-void primeSieve(uint32_t min, uint32_t max, vector<uint32_t> &primes)
+void SegmentedSieve::Init(uint64_t minIn, uint64_t maxIn)
+{
+    vector<uint32_t> primes;
+    basePrimeSieve((uint32_t)isqrt(maxIn), primes);
+
+    Init(minIn, maxIn, primes);
+}
+
+/**
+ * SegmentedSieve::Init - Set up a segmented sieve over [min, max] with a precomputed
+ * list of primes. For each prime past the pre-sieved ones, find its first multiple
+ * p * k to cross off: k is at least p and at least min / p, rounded up to the next
+ * value on the wheel.
+ *
+ * @param minIn Smallest value to report primes for.
+ * @param maxIn Largest value to report primes for.
+ * @param primes All primes up to at least sqrt(maxIn), in increasing order.
+ */
+
+void SegmentedSieve::Init(uint64_t minIn, uint64_t maxIn, const vector<uint32_t> &primes)
 {
-    vector<uint32_t> scratch;
-    scratch.resize(max - min + 1, 0);
+    assert(maxIn < 0x8000000000000000ULL);
+
+    min         = minIn;
+    max         = maxIn;
+    low         = min / 30;
+    endByte     = max / 30 + 1;
+    started     = false;
+    hasSmall    = false;
 
-    uint32_t primeCnt = 0;
+    sievingPrimes.clear();
+    nextBytes.clear();
+    wheelIdx.clear();
 
-    for (uint32_t i = 2; i <= max / 2; i++)
+    uint64_t lowValue = 30 * low;
+
+    for (uint32_t i = 0; i < primes.size(); i++)
     {
-        uint32_t factor = (min / i) * i;
-        factor = 2 * i > factor ? 2 * i : factor;
-        
-        if (factor < min)
+        uint64_t p = primes[i];
+
+        if (p <= presieveMax)
         {
-            factor += i;
+            continue;
         }
 
-        while (factor <= max)
+        if (p * p > max)
         {
-            scratch[factor - min] = 1;
-            factor += i;
+            break;
         }
-    }
 
-    // Count how many primes are left over.
+        uint64_t k = (lowValue + p - 1) / p;
 
-    for (uint32_t i = 0; i <= max - min; i++)
-    {
-        if (scratch[i] == 0)
+        if (k < p)
         {
-            primeCnt++;
+            k = p;
         }
-    }
-
-    // Put them in the output vector and done.
 
-    primes.resize(primeCnt);
+        uint32_t idx = 0;
 
-    for (uint32_t i = 0, j = 0; i <= max - min; i++)
-    {
-        if (scratch[i] == 0)
+        while (wheel30[idx] < k % 30)
         {
-            primes[j++] = i + min;
+            idx++;
         }
+
+        uint64_t multiple = p * (30 * (k / 30) + wheel30[idx]);
+
+        sievingPrimes.push_back((uint32_t)p);
+        nextBytes.push_back(multiple / 30);
+        wheelIdx.push_back((uint8_t)idx);
     }
+
+    segment.reserve(sieveSegmentBytes);
 }
 
 /**
- * primeSieve - Same as above, but put primes in a hash table
- * for quicker lookup.
+ * SegmentedSieve::NextSegment - Sieve the next block of up to sieveSegmentBytes wheel
+ * bytes. Each sieving prime resumes from the multiple and wheel position it stopped at
+ * in the last segment, so no divisions are needed after Init. Bits for values outside
+ * [min, max] in the first and last bytes are cleared so callers never see them.
  *
- * @param max Generate all prime numbers up to this value.
- * @param primes (out) A list of all the primes found.
+ * @return True if a new segment was sieved, false if the whole range is done.
  */
 
-void primeSieve(uint32_t max, unordered_set<uint32_t> &primes)
+bool SegmentedSieve::NextSegment()
 {
-    vector<uint32_t> scratch(max + 1);
+    bool first = !started;
+
+    if (started)
+    {
+        low += segment.size();
+    }
 
-    scratch[0] = 1;
-    scratch[1] = 1;
+    started     = true;
+    hasSmall    = first && min <= 5 && max >= 2;
 
-    uint32_t primeCnt = 0;
+    if (min > max || low >= endByte)
+    {
+        segment.clear();
+        return false;
+    }
+
+    uint64_t numBytes = endByte - low;
+
+    if (numBytes > sieveSegmentBytes)
+    {
+        numBytes = sieveSegmentBytes;
+    }
 
-    // Starting at 2, loop through multiples of numbers and mark 
-    // them as composite.
+    uint64_t segEnd = low + numBytes;
+    segment.resize((size_t)numBytes);
 
-    for (uint32_t i = 2; i <= max / 2; i++)
+    uint8_t* pBytes = segment.data();
+    presieve(pBytes, low, (size_t)numBytes);
+
+    for (size_t j = 0; j < sievingPrimes.size(); j++)
     {
-        if (scratch[i] == 1)
+        uint64_t byte = nextBytes[j];
+
+        if (byte >= segEnd)
         {
             continue;
         }
 
-        uint32_t factor = 2 * i;
-        while (factor <= max)
+        uint32_t p          = sievingPrimes[j];
+        uint64_t q          = p / 30;
+        uint32_t a          = wheel30BitIndex[p % 30];
+        uint32_t idx        = wheelIdx[j];
+
+        const uint8_t* pClear = wheelClear[a];
+        const uint8_t* pCarry = wheelCarry[a];
+
+        while (byte < segEnd)
         {
-            scratch[factor] = 1;
-            factor += i;
+            pBytes[byte - low] &= pClear[idx];
+            byte += q * wheelGap[idx] + pCarry[idx];
+            idx = (idx + 1) & 7;
         }
+
+        nextBytes[j]    = byte;
+        wheelIdx[j]     = (uint8_t)idx;
     }
 
-    // Count how many primes are left over.
+    // Put back the pre-sieved primes, which their own patterns crossed off. 1 isn't
+    // prime, and mask off values outside [min, max] at the ends.
 
-    for (uint32_t i = 1; i <= max; i++)
+    for (uint32_t p : presievePrimes)
     {
-        if (scratch[i] == 0)
+        if (p / 30 >= low && p / 30 < segEnd)
         {
-            primeCnt++;
+            pBytes[p / 30 - low] |= 1 << wheel30BitIndex[p % 30];
         }
     }
 
-    // Put them in the output vector and done.
+    if (low == 0)
+    {
+        segment[0] &= 0xFE;
+    }
 
-    for (uint32_t i = 1, j = 0; i <= max; i++)
+    if (first)
     {
-        if (scratch[i] == 0)
+        for (uint32_t k = 0; k < 8; k++)
         {
-            primes.insert(i);
+            if (30 * low + wheel30[k] < min)
+            {
+                segment[0] &= ~(1 << k);
+            }
         }
     }
-}
 
-/**
- * isPrime - Check if a number is prime by trial division.
- *
- * @param value Value to check for primality.
- * @param primes List of primes to use for trial divisions.
- *
- * @return True if input is prime, false otherwise.
- */
-
-bool isPrime(uint64_t value, vector<uint32_t> &primes)
-{
-    uint32_t i = 0;
-    uint64_t curPrime = (uint64_t)primes[i];
-
-    while (curPrime * curPrime <= value && i < primes.size())
+    if (segEnd == endByte)
     {
-        if (value % curPrime == 0)
+        for (uint32_t k = 0; k < 8; k++)
         {
-            return false;
+            if (30 * (segEnd - 1) + wheel30[k] > max)
+            {
+                segment[(size_t)numBytes - 1] &= ~(1 << k);
+            }
         }
-
-        i++;
-        curPrime = (uint64_t)primes[i];
     }
 
     return true;
 }
 
 /**
- * writePrimesToFile - Write computed primes to a file.
+ * PrimeIterator::Init - Start iterating from a value. Nothing is sieved until the first
+ * call to Next() or Prev().
  *
- * @param fileName Name of output file.
- * @param primes List of primes to write to file.
+ * @param start Next() returns primes >= start and Prev() returns primes < start.
  */
 
-void writePrimesToFile(const char* fileName, vector<uint32_t> &primes)
+void PrimeIterator::Init(uint64_t start)
 {
-    ofstream primeFile;
-    primeFile.open(fileName);
-    
-    for (uint32_t i = 0; i < primes.size(); i++)
-    {
-        primeFile << primes[i] << " ";
-        if (i > 0 && i % 100 == 0)
-        {
-            primeFile << "\n";
-        }
-    }
+    assert(start <= primeIteratorLimit + 1);
+
+    lo          = start;
+    end         = start;
+    windowSize  = 1 << 12;
+    pos         = 0;
+    baseMax     = 0;
 
-    primeFile.close();
+    window.clear();
+    basePrimes.clear();
 }
 
 /**
- * readPrimesFromFile - Write computed primes to a file.
+ * PrimeIterator::Fill - Sieve a new window, making sure the sieving primes reach
+ * sqrt of its top end. They're grown geometrically so a long forward scan only
+ * re-sieves them a handful of times.
  *
- * @param fileName Name of input file.
- * @param primes List of primes to populate from file.
- * @param max Read in all primes less than or equal to this max value. If zero,
- * read all primes from file.
+ * @param loIn  First value in the window.
+ * @param endIn One past the last value in the window.
  */
 
-void readPrimesFromFile(const char* fileName, vector<uint32_t> &primes, uint32_t max)
+void PrimeIterator::Fill(uint64_t loIn, uint64_t endIn)
 {
-    uint32_t exponent = 0;
-    uint32_t tmpMax = max / 10;
+    assert(loIn < endIn);
 
-    while (tmpMax)
-    {
-        exponent++;
-        tmpMax /= 10;
-    }
+    lo  = loIn;
+    end = endIn;
 
-    uint32_t numPrimes = primePi(exponent);
-    primes.resize(numPrimes + 1);
-
-    ifstream primeFile;
-    string line;
-    primeFile.open(fileName);
-    uint32_t inPrime;
-    uint32_t i = 0;
+    uint64_t root = isqrt(end - 1);
 
-    while (!primeFile.eof())
+    if (root > baseMax || basePrimes.empty())
     {
-        primeFile >> inPrime;
-        if (inPrime > max)
+        uint64_t newMax = 2 * (uint64_t)baseMax;
+
+        if (newMax < root)
         {
-            primeFile.close();
-            return;
+            newMax = root;
+        }
+
+        if (newMax < 1024)
+        {
+            newMax = 1024;
         }
 
-        primes[i++] = inPrime;
+        baseMax = (uint32_t)(newMax > 0xFFFFFFFF ? 0xFFFFFFFF : newMax);
+        basePrimeSieve(baseMax, basePrimes);
     }
 
-    primeFile.close();
+    window.clear();
+    sieve.Init(lo, end - 1, basePrimes);
+
+    while (sieve.NextSegment())
+    {
+        sieve.ForEachPrime([&](uint64_t p) { window.push_back(p); });
+    }
 }
 
 /**
- * readPrimesFromFile - Same as above, but read primes into a hash table.
- *
- * @param fileName Name of input file.
- * @param primes List of primes to populate from file.
- * @param max Read in all primes less than or equal to this max value. If zero,
- * read all primes from file.
+ * PrimeIterator::Grow - Double the window size up to one sieve segment, or sqrt of
+ * the current position if that's bigger, so setting up each window's sieving primes
+ * stays cheap next to sieving the window itself.
  */
 
-void readPrimesFromFile(const char* fileName, unordered_set<uint32_t> &primes, uint32_t max)
+void PrimeIterator::Grow()
 {
-    uint32_t exponent = 0;
-    uint32_t tmpMax = max / 10;
+    uint64_t cap    = 30 * (uint64_t)sieveSegmentBytes;
+    uint64_t root   = isqrt(end - 1);
 
-    while (tmpMax)
+    if (cap < root)
     {
-        exponent++;
-        tmpMax /= 10;
+        cap = root;
     }
 
-    uint32_t numPrimes = primePi(exponent);
-    primes.reserve(numPrimes + 1);
-
-    ifstream primeFile;
-    primeFile.open(fileName);
-    uint32_t inPrime;
-
-    while (!primeFile.eof())
+    if (windowSize < cap)
     {
-        primeFile >> inPrime;
-        if (inPrime > max)
-        {
-            primeFile.close();
-            return;
-        }
-
-        primes.insert(inPrime);
+        windowSize = (2 * windowSize < cap) ? 2 * windowSize : cap;
     }
-
-    primeFile.close();
 }
 
 /**
- * primePi - Return number of primes up to 10^exponent.
- *
- * @param exponent Value of exponent for pi(10^exponent).
+ * PrimeBitset::Init - Build a bitset of all primes up to max. Segments from the
+ * segmented sieve are already in the right format, so just copy them in.
  *
- * @return Number of primes up to 10^exponent.
+ * @param maxIn Include all primes up to this value.
  */
 
-uint32_t primePi(uint32_t exponent)
+void PrimeBitset::Init(uint64_t maxIn)
 {
-    const uint32_t piVals[11] =
-    {
-        0,
-        4,
-        25,
-        168,
-        1229,
-        9592,
-        78498,
-        664579,
-        5761455,
-        50847534,
-        455052511
-    };
+    max = maxIn;
+    bits.assign((size_t)(max / 30 + 1), 0);
 
-    return piVals[exponent];
+    SegmentedSieve sieve;
+    sieve.Init(0, max);
+
+    while (sieve.NextSegment())
+    {
+        memcpy(&bits[(size_t)sieve.low], sieve.segment.data(), sieve.segment.size());
+    }
 }
 
 /**
- * factorSieve - Perform a prime sieve while storing prime factorizations
- * as we go.
- *
- * @param max Max value to factor.
- * @param values Out. A list from 0 - max with prime factorizations. 
+ * PrimeBitset::InitCounts - Build running prime counts for countPrimes. Entry i is the
+ * number of set bits in all bytes before byte 8i.
  */
 
-void factorSieve(uint32_t max, vector<vector<primePower>> &values)
+void PrimeBitset::InitCounts()
 {
-    values.resize(max + 1);
-    values[1].push_back({ 1, 1 });
+    size_t numWords = bits.size() / 8 + 1;
+    wordCounts.resize(numWords);
 
-    for (uint32_t i = 2; i <= max; i++)
-    {
-        if (values[i].size() == 0)
-        {
-            values[i].push_back({ i, 1 });
-            
-            uint32_t tmp = 2 * i;
+    uint32_t count = 0;
 
-            while (tmp <= max)
-            {
-                uint32_t tmp2 = tmp;
-                uint32_t pwr = 0;
+    for (size_t i = 0; i < numWords; i++)
+    {
+        wordCounts[i] = count;
 
-                while (tmp2 % i == 0)
-                {
-                    pwr++;
-                    tmp2 /= i;
-                }
+        uint64_t word = 0;
+        size_t len = bits.size() - 8 * i < 8 ? bits.size() - 8 * i : 8;
+        memcpy(&word, &bits[8 * i], len);
 
-                values[tmp].push_back({ i, pwr });
-                tmp += i;
-            }
-        }
+        count += popcount64(word);
     }
 }
 
 /**
- * [factorTrialDivision Get prime factors of a value by trial division.]
- * @param primes  A list of primes to do trival division with.
- * @param factors Out list of prime powers of value.
- * @param value   Value to get prime factorization for.
+ * primeSieve - Generate a list of prime numbers up to a maximum value.
+ * Thin wrapper around the segmented sieve.
+ *
+ * @param max Generate all prime numbers up to this value.
+ * @param primes (out) A list of all the primes found.
  */
 
-void factorTrialDivision(vector<uint32_t> &primes, vector<primePower> &factors, uint64_t value)
+void primeSieve(uint32_t max, vector<uint32_t> &primes)
+{
+    primes.clear();
+    primes.reserve(primeCountBound(max));
+
+    SegmentedSieve sieve;
+    sieve.Init(0, max);
+
+    while (sieve.NextSegment())
+    {
+        sieve.ForEachPrime([&](uint64_t p) { primes.push_back((uint32_t)p); });
+    }
+}
+
+/**
+ * primeSieve - Prime sieve, 64-bit version.
+ * 
+ * @param max Generate all prime numbers up to this value.
+ * @param primes (out) A list of all the primes found.
+ */
+
+void primeSieve(uint64_t max, vector<uint64_t> &primes)
+{
+    primes.clear();
+    primes.reserve(primeCountBound(max));
+
+    SegmentedSieve sieve;
+    sieve.Init(0, max);
+
+    while (sieve.NextSegment())
+    {
+        sieve.ForEachPrime([&](uint64_t p) { primes.push_back(p); });
+    }
+}
+
+/**
+ * primeSieve - Use sieving to generate a list of primes betwee
+ * a min and max value, inclusive. Only primes up to sqrt(max) are used
+ * to cross off the window, so the cost is about (max - min) log log max
+ * plus sqrt(max) for the sieving primes.
+ *
+ * @param min Generate primes including and above this value.
+ * @param max Generate all prime numbers up to and including this value.
+ * @param primes (out) A list of all the primes found.
+ */
+
+void primeSieve(uint32_t min, uint32_t max, vector<uint32_t> &primes)
+{
+    primes.clear();
+
+    SegmentedSieve sieve;
+    sieve.Init(min, max);
+
+    while (sieve.NextSegment())
+    {
+        sieve.ForEachPrime([&](uint64_t p) { primes.push_back((uint32_t)p); });
+    }
+}
+
+/**
+ * primeSieve - Range sieve, 64-bit version, for windows anywhere
+ * below 2^63.
+ *
+ * @param min Generate primes including and above this value.
+ * @param max Generate all prime numbers up to and including this value.
+ * @param primes (out) A list of all the primes found.
+ */
+
+void primeSieve(uint64_t min, uint64_t max, vector<uint64_t> &primes)
+{
+    primes.clear();
+
+    SegmentedSieve sieve;
+    sieve.Init(min, max);
+
+    while (sieve.NextSegment())
+    {
+        sieve.ForEachPrime([&](uint64_t p) { primes.push_back(p); });
+    }
+}
+
+/**
+ * primeSieveParallel - Multithreaded version of the range sieve above. Split [min, max]
+ * into chunks of a few segments each and sieve them as tasks on the shared thread pool.
+ * Sieving primes are computed once and shared; each chunk finds its own starting
+ * multiples and collects its primes into its own list. Chunks are then concatenated
+ * in order.
+ *
+ * @param min Generate primes including and above this value.
+ * @param max Generate all prime numbers up to and including this value.
+ * @param primes (out) A list of all the primes found.
+ * @param numChunks Number of chunks to split the range into. Zero picks a few per
+ * worker thread, with chunks no smaller than 4096 wheel bytes.
+ */
+
+void primeSieveParallel(uint32_t min, uint32_t max, vector<uint32_t> &primes, uint32_t numChunks)
+{
+    primes.clear();
+
+    if (min > max)
+    {
+        return;
+    }
+
+    ThreadPool &pool = GetThreadPool();
+
+    uint64_t firstByte  = min / 30;
+    uint64_t numBytes   = max / 30 - firstByte + 1;
+
+    if (numChunks == 0)
+    {
+        numChunks = 8 * pool.NumThreads();
+
+        if (numBytes / numChunks < 4096)
+        {
+            numChunks = (uint32_t)(numBytes / 4096) + 1;
+        }
+    }
+
+    uint64_t chunkBytes = (numBytes + numChunks - 1) / numChunks;
+
+    vector<uint32_t> basePrimes;
+    basePrimeSieve((uint32_t)isqrt(max), basePrimes);
+
+    vector<vector<uint32_t>> chunkPrimes(numChunks);
+    TaskGroup group;
+
+    for (uint32_t i = 0; i < numChunks; i++)
+    {
+        uint64_t chunkMin = 30 * (firstByte + i * chunkBytes);
+        uint64_t chunkMax = chunkMin + 30 * chunkBytes - 1;
+
+        chunkMin = chunkMin < min ? min : chunkMin;
+        chunkMax = chunkMax > max ? max : chunkMax;
+
+        if (chunkMin > chunkMax)
+        {
+            continue;
+        }
+
+        pool.Submit([&, i, chunkMin, chunkMax]()
+        {
+            SegmentedSieve sieve;
+            sieve.Init(chunkMin, chunkMax, basePrimes);
+
+            vector<uint32_t> &out = chunkPrimes[i];
+
+            while (sieve.NextSegment())
+            {
+                sieve.ForEachPrime([&](uint64_t p) { out.push_back((uint32_t)p); });
+            }
+        }, &group);
+    }
+
+    pool.Wait(group);
+
+    size_t total = 0;
+
+    for (auto &chunk : chunkPrimes)
+    {
+        total += chunk.size();
+    }
+
+    primes.reserve(total);
+
+    for (auto &chunk : chunkPrimes)
+    {
+        primes.insert(primes.end(), chunk.begin(), chunk.end());
+    }
+}
+
+/**
+ * primeSieve - Same as above, but put primes in a hash table
+ * for quicker lookup.
+ *
+ * @param max Generate all prime numbers up to this value.
+ * @param primes (out) A list of all the primes found.
+ */
+
+void primeSieve(uint32_t max, unordered_set<uint32_t> &primes)
+{
+    primes.reserve(primeCountBound(max));
+
+    SegmentedSieve sieve;
+    sieve.Init(0, max);
+
+    while (sieve.NextSegment())
+    {
+        sieve.ForEachPrime([&](uint64_t p) { primes.insert((uint32_t)p); });
+    }
+}
+
+/**
+ * isPrime - Check if a number is prime by trial division.
+ *
+ * @param value Value to check for primality.
+ * @param primes List of primes to use for trial divisions.
+ *
+ * @return True if input is prime, false otherwise.
+ */
+
+bool isPrime(uint64_t value, vector<uint32_t> &primes)
+{
+    uint32_t i = 0;
+    uint64_t curPrime = (uint64_t)primes[i];
+
+    while (curPrime * curPrime <= value && i < primes.size())
+    {
+        if (value % curPrime == 0)
+        {
+            return false;
+        }
+
+        i++;
+        curPrime = (uint64_t)primes[i];
+    }
+
+    return true;
+}
+
+/**
+ * isPrime - Deterministic Miller-Rabin primality test for 64-bit values. Trial divide
+ * by the primes below 64 first, which settles everything below 67^2 and most
+ * composites. Then run Miller-Rabin with Jim Sinclair's seven bases, which have no
+ * strong pseudoprimes below 2^64. All the modular arithmetic is in Montgomery form.
+ *
+ * @param value Value to check for primality.
+ *
+ * @return True if input is prime, false otherwise.
+ */
+
+bool isPrime(uint64_t value)
+{
+    static const uint32_t smallPrimes[18] =
+    {
+        2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61
+    };
+
+    static const uint64_t bases[7] =
+    {
+        2, 325, 9375, 28178, 450775, 9780504, 1795265022
+    };
+
+    if (value < 2)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < 18; i++)
+    {
+        if (value % smallPrimes[i] == 0)
+        {
+            return value == smallPrimes[i];
+        }
+    }
+
+    if (value < 67 * 67)
+    {
+        return true;
+    }
+
+    // value - 1 = d * 2^s with d odd.
+
+    uint64_t d = value - 1;
+    uint32_t s = ctz64(d);
+    d >>= s;
+
+    Montgomery64 mont;
+    mont.Init(value);
+
+    uint64_t one        = mont.one;
+    uint64_t minusOne   = value - mont.one;
+
+    for (uint32_t i = 0; i < 7; i++)
+    {
+        uint64_t a = bases[i] % value;
+
+        if (a == 0)
+        {
+            continue;
+        }
+
+        uint64_t x = mont.Pow(mont.ToMont(a), d);
+
+        if (x == one || x == minusOne)
+        {
+            continue;
+        }
+
+        bool witness = true;
+
+        for (uint32_t r = 1; r < s; r++)
+        {
+            x = mont.Mul(x, x);
+
+            if (x == minusOne)
+            {
+                witness = false;
+                break;
+            }
+        }
+
+        if (witness)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * pollardBrent - Find a nontrivial factor of an odd composite with Brent's variant of
+ * Pollard's rho. Iterate x -> x^2 + c mod n in Montgomery form (which doesn't change
+ * any gcds with n, since R is coprime to n). Rather than a gcd per step, multiply
+ * batches of |x - y| together and take one gcd per batch. If a batch overshoots and
+ * the gcd comes back as n, replay it one step at a time from the saved start. If
+ * even that fails, the cycle closed without splitting n, so try the next c.
+ *
+ * @param n Odd composite value to split.
+ *
+ * @return A factor of n strictly between 1 and n.
+ */
+
+static uint64_t pollardBrent(uint64_t n)
+{
+    const uint32_t batchSize = 128;
+
+    Montgomery64 mont;
+    mont.Init(n);
+
+    for (uint64_t c = 1; ; c++)
+    {
+        uint64_t cM = mont.ToMont(c);
+        uint64_t y  = mont.ToMont(2);
+        uint64_t x  = y;
+        uint64_t ys = y;
+        uint64_t q  = mont.one;
+        uint64_t g  = 1;
+
+        for (uint64_t r = 1; g == 1; r <<= 1)
+        {
+            x = y;
+
+            for (uint64_t i = 0; i < r; i++)
+            {
+                y = mont.Add(mont.Mul(y, y), cM);
+            }
+
+            for (uint64_t k = 0; k < r && g == 1; k += batchSize)
+            {
+                ys = y;
+                uint64_t steps = r - k < batchSize ? r - k : batchSize;
+
+                for (uint64_t i = 0; i < steps; i++)
+                {
+                    y = mont.Add(mont.Mul(y, y), cM);
+                    q = mont.Mul(q, x > y ? x - y : y - x);
+                }
+
+                g = gcdBinary64(q, n);
+            }
+        }
+
+        if (g == n)
+        {
+            do
+            {
+                ys = mont.Add(mont.Mul(ys, ys), cM);
+                g = gcdBinary64(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+
+        if (g != n)
+        {
+            return g;
+        }
+    }
+}
+
+/**
+ * factorSplit - Recursively split a value with no small factors into its prime
+ * factors.
+ *
+ * @param value Value to split. Has no prime factors below the trial division bound.
+ * @param primes (out) Prime factors found, with repeats, in no particular order.
+ */
+
+static void factorSplit(uint64_t value, vector<uint64_t> &primes)
+{
+    if (value == 1)
+    {
+        return;
+    }
+
+    if (isPrime(value))
+    {
+        primes.push_back(value);
+        return;
+    }
+
+    uint64_t d = pollardBrent(value);
+
+    factorSplit(d, primes);
+    factorSplit(value / d, primes);
+}
+
+/**
+ * factor64 - Factor any 64-bit value. Trial divide by the primes below 1024, which
+ * strips all the small factors cheaply, then split whatever is left with
+ * Miller-Rabin and Pollard-Brent rho.
+ *
+ * @param value   Value to get prime factorization for.
+ * @param factors (out) Prime powers of value, in increasing order of prime.
+ */
+
+void factor64(uint64_t value, vector<primePower64> &factors)
+{
+    static const uint32_t trialBound = 1024;
+    static vector<uint32_t> smallPrimes;
+    static once_flag initFlag;
+
+    call_once(initFlag, []() { basePrimeSieve(trialBound - 1, smallPrimes); });
+
+    factors.clear();
+
+    if (value < 2)
+    {
+        return;
+    }
+
+    for (uint32_t p : smallPrimes)
+    {
+        if ((uint64_t)p * p > value)
+        {
+            break;
+        }
+
+        if (value % p == 0)
+        {
+            primePower64 newFactor = { p, 0 };
+
+            while (value % p == 0)
+            {
+                newFactor.power++;
+                value /= p;
+            }
+
+            factors.push_back(newFactor);
+        }
+    }
+
+    // Anything left below trialBound^2 with no factor below trialBound is prime.
+
+    if (value < (uint64_t)trialBound * trialBound)
+    {
+        if (value > 1)
+        {
+            factors.push_back({ value, 1 });
+        }
+
+        return;
+    }
+
+    vector<uint64_t> bigPrimes;
+    factorSplit(value, bigPrimes);
+    sort(bigPrimes.begin(), bigPrimes.end());
+
+    for (uint64_t p : bigPrimes)
+    {
+        if (factors.size() > 0 && factors.back().prime == p)
+        {
+            factors.back().power++;
+        }
+        else
+        {
+            factors.push_back({ p, 1 });
+        }
+    }
+}
+
+/**
+ * primePi - Return number of primes up to 10^exponent.
+ *
+ * @param exponent Value of exponent for pi(10^exponent).
+ *
+ * @return Number of primes up to 10^exponent.
+ */
+
+uint32_t primePi(uint32_t exponent)
+{
+    const uint32_t piVals[11] =
+    {
+        0,
+        4,
+        25,
+        168,
+        1229,
+        9592,
+        78498,
+        664579,
+        5761455,
+        50847534,
+        455052511
+    };
+
+    return piVals[exponent];
+}
+
+// Partial sieve function tables. phi(x, a) counts the values in [1, x] with no prime
+// factor among the first a primes. For a <= phiSmallA it's periodic in the product of
+// those primes, so look it up directly. Almost all calls in the phi recursion are for
+// small x, so also tabulate phi(x, a) outright for x < phiCacheX and every a with
+// p_a^2 <= x there, i.e., the primes below 256. Larger a are handled by prime counts.
+
+static const uint32_t phiSmallA = 6;
+static const uint32_t phiSmallPrimes[phiSmallA] = { 2, 3, 5, 7, 11, 13 };
+static const uint32_t phiCacheX = 1 << 16;
+static const uint32_t phiCacheA = 54;
+
+struct PhiTables
+{
+    uint32_t prods[phiSmallA + 1];
+    uint32_t totients[phiSmallA + 1];
+    vector<uint16_t> counts[phiSmallA + 1];
+    vector<uint16_t> cache;
+
+    PhiTables()
+    {
+        prods[0]    = 1;
+        totients[0] = 1;
+        counts[0].assign(1, 0);
+
+        for (uint32_t a = 1; a <= phiSmallA; a++)
+        {
+            uint32_t p  = phiSmallPrimes[a - 1];
+            prods[a]    = prods[a - 1] * p;
+            totients[a] = totients[a - 1] * (p - 1);
+
+            counts[a].resize(prods[a]);
+
+            uint16_t count = 0;
+
+            for (uint32_t x = 0; x < prods[a]; x++)
+            {
+                bool coprime = (x != 0);
+
+                for (uint32_t i = 0; i < a && coprime; i++)
+                {
+                    coprime = (x % phiSmallPrimes[i]) != 0;
+                }
+
+                count += coprime;
+                counts[a][x] = count;
+            }
+        }
+
+        // Sieve [0, phiCacheX) one prime at a time, taking running counts of the
+        // survivors after each.
+
+        vector<uint32_t> primes;
+        basePrimeSieve(255, primes);
+        assert(primes.size() == phiCacheA);
+
+        vector<uint8_t> survivors(phiCacheX, 1);
+        survivors[0] = 0;
+
+        cache.resize((size_t)(phiCacheA + 1) * phiCacheX);
+
+        for (uint32_t a = 0; a <= phiCacheA; a++)
+        {
+            if (a > 0)
+            {
+                for (uint32_t m = primes[a - 1]; m < phiCacheX; m += primes[a - 1])
+                {
+                    survivors[m] = 0;
+                }
+            }
+
+            uint16_t* pCache    = &cache[(size_t)a * phiCacheX];
+            uint32_t count      = 0;
+
+            for (uint32_t x = 0; x < phiCacheX; x++)
+            {
+                count += survivors[x];
+                pCache[x] = (uint16_t)count;
+            }
+        }
+    }
+
+    uint64_t Phi(uint64_t x, uint32_t a) const
+    {
+        return (x / prods[a]) * totients[a] + counts[a][(size_t)(x % prods[a])];
+    }
+
+    uint64_t Cached(uint64_t x, uint32_t a) const
+    {
+        assert(x < phiCacheX && a <= phiCacheA);
+        return cache[(size_t)a * phiCacheX + (size_t)x];
+    }
+};
+
+/**
+ * PrimeCounter - State for one Meissel-Lehmer evaluation of pi(x): the primes up to
+ * x^(1/2) and a bitset with prime counts up to x^(2/3).
+ */
+
+struct PrimeCounter
+{
+    const PhiTables &small;
+    PrimeBitset table;
+    vector<uint32_t> primes;
+
+    PrimeCounter(const PhiTables &smallIn) : small(smallIn) {};
+
+    /**
+     * phi - Partial sieve function phi(x, a). Unroll the Legendre recurrence
+     * phi(x, a) = phi(x, a - 1) - phi(x / p_a, a - 1) down to the small-a tables:
+     *
+     *     phi(x, a) = phi(x, 6) - sum over 6 < i <= a of phi(x / p_i, i - 1).
+     *
+     * Once p_a^2 > x, everything left in [1, x] is 1 or a prime above p_a and the count
+     * comes straight from the table. Small x come from the phi cache. Inside the sum, once
+     * x / p_i < p_(i-1) every remaining term is 1 (or 0 once p_i > x), so they're added
+     * up in one go.
+     *
+     * @param x Count values up to this value.
+     * @param a Number of primes to sieve by.
+     *
+     * @return Number of values in [1, x] not divisible by any of the first a primes.
+     */
+
+    uint64_t phi(uint64_t x, uint32_t a) const
+    {
+        if (a <= phiSmallA)
+        {
+            return small.Phi(x, a);
+        }
+
+        uint64_t p = primes[a - 1];
+
+        if (x <= table.max && p * p > x)
+        {
+            return x >= p ? table.countPrimes(x) - a + 1 : 1;
+        }
+
+        if (x < phiCacheX)
+        {
+            return small.Cached(x, a);
+        }
+
+        uint64_t sum = small.Phi(x, phiSmallA);
+
+        for (uint32_t i = phiSmallA + 1; i <= a; i++)
+        {
+            uint64_t y = x / primes[i - 1];
+
+            if (y < primes[i - 2] && x <= table.max)
+            {
+                uint64_t numOnes = table.countPrimes(x);
+                numOnes = numOnes < a ? numOnes : a;
+
+                if (numOnes >= i)
+                {
+                    sum -= numOnes - i + 1;
+                }
+
+                break;
+            }
+
+            sum -= phi(y, i - 1);
+        }
+
+        return sum;
+    }
+};
+
+/**
+ * primeCount - Count the primes up to x without listing them, using Meissel's
+ * formula:
+ *
+ *     pi(x) = phi(x, a) + a - 1 - P2(x, a),
+ *
+ * where a = pi(x^(1/3)) and P2 counts the products of two primes above x^(1/3),
+ * P2 = sum over primes x^(1/3) < p <= x^(1/2) of pi(x / p) - pi(p) + 1. Every x / p
+ * in that sum is below x^(2/3), so sieve a counting bitset that far and the rest
+ * is lookups and the phi recursion. Takes ~2s and ~30MB for x = 1e13.
+ *
+ * @param x Count primes up to and including this value.
+ *
+ * @return pi(x).
+ */
+
+uint64_t primeCount(uint64_t x)
+{
+    static const PhiTables small;
+
+    if (x < 2)
+    {
+        return 0;
+    }
+
+    uint64_t cbrtX = (uint64_t)cbrt((double)x);
+
+    while (cbrtX * cbrtX * cbrtX > x)
+    {
+        cbrtX--;
+    }
+
+    while ((cbrtX + 1) * (cbrtX + 1) * (cbrtX + 1) <= x)
+    {
+        cbrtX++;
+    }
+
+    uint64_t sqrtX      = isqrt(x);
+    uint64_t tableMax   = (cbrtX + 1) * (cbrtX + 1);
+
+    if (tableMax < sqrtX)
+    {
+        tableMax = sqrtX;
+    }
+
+    PrimeCounter counter(small);
+    counter.table.Init(tableMax < x ? tableMax : x);
+    counter.table.InitCounts();
+
+    if (x <= tableMax)
+    {
+        return counter.table.countPrimes(x);
+    }
+
+    basePrimeSieve((uint32_t)sqrtX, counter.primes);
+
+    uint32_t a = (uint32_t)counter.table.countPrimes(cbrtX);
+    uint32_t b = (uint32_t)counter.primes.size();
+
+    uint64_t p2 = 0;
+
+    for (uint32_t i = a; i < b; i++)
+    {
+        uint64_t p = counter.primes[i];
+        p2 += counter.table.countPrimes(x / p) - i;
+    }
+
+    return counter.phi(x, a) + a - 1 - p2;
+}
+
+/**
+ * spfSieve - Sieve the smallest prime factor of every value up to max into a flat
+ * array. Evens get 2, then each odd prime p claims the multiples p^2, p^2 + 2p, ...
+ * that no smaller prime got to first. 4 bytes per value, and factoring any n <= max
+ * afterwards is a handful of lookups (see SpfFactorIterator).
+ *
+ * @param max Max value to sieve.
+ * @param spf (out) spf[n] is the smallest prime factor of n. spf[0] = 0, spf[1] = 1.
+ */
+
+void spfSieve(uint32_t max, vector<uint32_t> &spf)
+{
+    spf.assign((size_t)max + 1, 0);
+
+    if (max >= 1)
+    {
+        spf[1] = 1;
+    }
+
+    for (uint64_t i = 2; i <= max; i += 2)
+    {
+        spf[(size_t)i] = 2;
+    }
+
+    for (uint64_t i = 3; i <= max; i += 2)
+    {
+        if (spf[(size_t)i] != 0)
+        {
+            continue;
+        }
+
+        spf[(size_t)i] = (uint32_t)i;
+
+        for (uint64_t j = i * i; j <= max; j += 2 * i)
+        {
+            if (spf[(size_t)j] == 0)
+            {
+                spf[(size_t)j] = (uint32_t)i;
+            }
+        }
+    }
+}
+
+/**
+ * factorSpf - Get the prime factorization of a value from a smallest prime
+ * factor table.
+ *
+ * @param spf Smallest prime factor table from spfSieve.
+ * @param value Value to factor. Must be covered by the table.
+ * @param factors (out) Prime powers of value, in increasing order of prime.
+ */
+
+void factorSpf(const vector<uint32_t> &spf, uint32_t value, vector<primePower> &factors)
+{
+    factors.clear();
+
+    SpfFactorIterator it(spf, value);
+    primePower factor;
+
+    while (it.Next(factor))
+    {
+        factors.push_back(factor);
+    }
+}
+
+/**
+ * factorSieve - Perform a prime sieve while storing prime factorizations
+ * as we go. Built from a smallest prime factor table. Prefer spfSieve with
+ * SpfFactorIterator for large max, since this allocates a list per value.
+ *
+ * @param max Max value to factor.
+ * @param values Out. A list from 0 - max with prime factorizations. 
+ */
+
+void factorSieve(uint32_t max, vector<vector<primePower>> &values)
+{
+    vector<uint32_t> spf;
+    spfSieve(max, spf);
+
+    values.resize(max + 1);
+    values[1].push_back({ 1, 1 });
+
+    for (uint32_t i = 2; i <= max; i++)
+    {
+        factorSpf(spf, i, values[i]);
+    }
+}
+
+/**
+ * MultiplicativeTable::Alloc - Size the requested tables for [min, max] and fill them
+ * with 1, the value of every multiplicative function at 1.
+ *
+ * @param minIn   First value covered.
+ * @param maxIn   Last value covered.
+ * @param funcsIn MULT_* flags for the functions to hold.
+ */
+
+void MultiplicativeTable::Alloc(uint64_t minIn, uint64_t maxIn, uint32_t funcsIn)
+{
+    assert(minIn <= maxIn);
+
+    min         = minIn;
+    max         = maxIn;
+    funcs       = funcsIn;
+    size_t size = (size_t)(max - min + 1);
+
+    totient.assign((funcs & MULT_TOTIENT) ? size : 0, 1);
+    mobius.assign((funcs & MULT_MOBIUS) ? size : 0, 1);
+    divisorCount.assign((funcs & MULT_DIVISORCOUNT) ? size : 0, 1);
+    divisorSum.assign((funcs & MULT_DIVISORSUM) ? size : 0, 1);
+    radical.assign((funcs & MULT_RADICAL) ? size : 0, 1);
+
+    if (min == 0)
+    {
+        if (funcs & MULT_TOTIENT)
+        {
+            totient[0] = 0;
+        }
+
+        if (funcs & MULT_MOBIUS)
+        {
+            mobius[0] = 0;
+        }
+
+        if (funcs & MULT_DIVISORCOUNT)
+        {
+            divisorCount[0] = 0;
+        }
+
+        if (funcs & MULT_DIVISORSUM)
+        {
+            divisorSum[0] = 0;
+        }
+
+        if (funcs & MULT_RADICAL)
+        {
+            radical[0] = 0;
+        }
+    }
+}
+
+/**
+ * MultiplicativeTable::Init - Fill tables for [0, max] with a linear sieve. For each
+ * i and each prime p up to the smallest prime of i, i * p is visited once:
+ *
+ *   - p doesn't divide i: f(i * p) = f(i) * f(p).
+ *   - p divides i: phi(i * p) = p * phi(i), mu = 0, rad(i * p) = rad(i), and since
+ *     d(p^e) and sigma(p^e) satisfy f_(e + 1) = (1 + p) f_e - p f_(e - 1), with
+ *     d using 2 in place of 1 + p and 1 in place of p, d(i * p) = 2d(i) - d(i / p)
+ *     and sigma(i * p) = (1 + p) sigma(i) - p sigma(i / p).
+ *
+ * @param maxIn   Last value covered.
+ * @param funcsIn MULT_* flags for the functions to fill.
+ */
+
+void MultiplicativeTable::Init(uint32_t maxIn, uint32_t funcsIn)
+{
+    Alloc(0, maxIn, funcsIn);
+
+    vector<uint32_t> primes;
+    primes.reserve(primeCountBound(max));
+    vector<bool> composite((size_t)max + 1, false);
+
+    for (uint64_t i = 2; i <= max; i++)
+    {
+        if (!composite[(size_t)i])
+        {
+            primes.push_back((uint32_t)i);
+
+            if (funcs & MULT_TOTIENT)
+            {
+                totient[(size_t)i] = i - 1;
+            }
+
+            if (funcs & MULT_MOBIUS)
+            {
+                mobius[(size_t)i] = -1;
+            }
+
+            if (funcs & MULT_DIVISORCOUNT)
+            {
+                divisorCount[(size_t)i] = 2;
+            }
+
+            if (funcs & MULT_DIVISORSUM)
+            {
+                divisorSum[(size_t)i] = i + 1;
+            }
+
+            if (funcs & MULT_RADICAL)
+            {
+                radical[(size_t)i] = i;
+            }
+        }
+
+        for (uint32_t j = 0; j < primes.size(); j++)
+        {
+            uint64_t p  = primes[j];
+            size_t ip   = (size_t)(i * p);
+
+            if (i * p > max)
+            {
+                break;
+            }
+
+            composite[ip] = true;
+
+            if (i % p == 0)
+            {
+                size_t ipp = (size_t)(i / p);
+
+                if (funcs & MULT_TOTIENT)
+                {
+                    totient[ip] = totient[(size_t)i] * p;
+                }
+
+                if (funcs & MULT_MOBIUS)
+                {
+                    mobius[ip] = 0;
+                }
+
+                if (funcs & MULT_DIVISORCOUNT)
+                {
+                    divisorCount[ip] = 2 * divisorCount[(size_t)i] - divisorCount[ipp];
+                }
+
+                if (funcs & MULT_DIVISORSUM)
+                {
+                    divisorSum[ip] = (1 + p) * divisorSum[(size_t)i] - p * divisorSum[ipp];
+                }
+
+                if (funcs & MULT_RADICAL)
+                {
+                    radical[ip] = radical[(size_t)i];
+                }
+
+                break;
+            }
+
+            if (funcs & MULT_TOTIENT)
+            {
+                totient[ip] = totient[(size_t)i] * (p - 1);
+            }
+
+            if (funcs & MULT_MOBIUS)
+            {
+                mobius[ip] = -mobius[(size_t)i];
+            }
+
+            if (funcs & MULT_DIVISORCOUNT)
+            {
+                divisorCount[ip] = 2 * divisorCount[(size_t)i];
+            }
+
+            if (funcs & MULT_DIVISORSUM)
+            {
+                divisorSum[ip] = (p + 1) * divisorSum[(size_t)i];
+            }
+
+            if (funcs & MULT_RADICAL)
+            {
+                radical[ip] = radical[(size_t)i] * p;
+            }
+        }
+    }
+}
+
+/**
+ * MultiplicativeTable::Init - Fill tables for the window [min, max]. Every value starts
+ * as its own residual. Each prime p <= sqrt(max) divides p^e out of the residuals of its
+ * multiples and folds f(p^e) into their entries. Exact division by p is a multiply by
+ * p's inverse mod 2^64, and the residual r is divisible again when r * pInv <= 2^64 / p.
+ * A residual above 1 afterwards is a single prime factor above sqrt(max).
+ *
+ * @param minIn   First value covered.
+ * @param maxIn   Last value covered.
+ * @param funcsIn MULT_* flags for the functions to fill.
+ * @param primes  Primes in increasing order, covering at least up to sqrt(maxIn).
+ */
+
+void MultiplicativeTable::Init(uint64_t minIn, uint64_t maxIn, uint32_t funcsIn, const vector<uint32_t> &primes)
+{
+    Alloc(minIn, maxIn, funcsIn);
+
+    size_t size = (size_t)(max - min + 1);
+    vector<uint64_t> residual(size);
+
+    for (size_t j = 0; j < size; j++)
+    {
+        residual[j] = min + j;
+    }
+
+    if (min == 0)
+    {
+        residual[0] = 1;
+    }
+
+    auto fold = [&](size_t j, uint64_t p, uint32_t e, uint64_t pk, uint64_t pkSum)
+    {
+        if (funcs & MULT_TOTIENT)
+        {
+            totient[j] *= pk / p * (p - 1);
+        }
+
+        if (funcs & MULT_MOBIUS)
+        {
+            mobius[j] = (e > 1) ? 0 : -mobius[j];
+        }
+
+        if (funcs & MULT_DIVISORCOUNT)
+        {
+            divisorCount[j] *= e + 1;
+        }
+
+        if (funcs & MULT_DIVISORSUM)
+        {
+            divisorSum[j] *= pkSum;
+        }
+
+        if (funcs & MULT_RADICAL)
+        {
+            radical[j] *= p;
+        }
+    };
+
+    for (uint32_t i = 0; i < primes.size(); i++)
+    {
+        uint64_t p = primes[i];
+
+        if (p * p > max)
+        {
+            break;
+        }
+
+        uint64_t first  = (min + p - 1) / p * p;
+        size_t j        = (size_t)(first - min);
+
+        if (first == 0)
+        {
+            j += (size_t)p;
+        }
+
+        if (p == 2)
+        {
+            for (; j < size; j += 2)
+            {
+                uint32_t e      = ctz64(residual[j]);
+                uint64_t pk     = (uint64_t)1 << e;
+                residual[j]     >>= e;
+
+                fold(j, 2, e, pk, 2 * pk - 1);
+            }
+
+            continue;
+        }
+
+        uint64_t pInv = p;
+
+        for (uint32_t k = 0; k < 5; k++)
+        {
+            pInv *= 2 - p * pInv;
+        }
+
+        uint64_t limit = UINT64_MAX / p;
+
+        for (; j < size; j += (size_t)p)
+        {
+            uint64_t r      = residual[j] * pInv;
+            uint32_t e      = 1;
+            uint64_t pk     = p;
+            uint64_t pkSum  = 1 + p;
+
+            while (r * pInv <= limit)
+            {
+                r       *= pInv;
+                pk      *= p;
+                pkSum   = pkSum * p + 1;
+                e++;
+            }
+
+            residual[j] = r;
+            fold(j, p, e, pk, pkSum);
+        }
+    }
+
+    for (size_t j = 0; j < size; j++)
+    {
+        uint64_t q = residual[j];
+
+        if (q > 1)
+        {
+            fold(j, q, 1, q, q + 1);
+        }
+    }
+}
+
+/**
+ * [factorTrialDivision Get prime factors of a value by trial division.]
+ * @param primes  A list of primes to do trival division with.
+ * @param factors Out list of prime powers of value.
+ * @param value   Value to get prime factorization for.
+ */
+
+void factorTrialDivision(vector<uint32_t> &primes, vector<primePower> &factors, uint64_t value)
 {
     for (uint32_t i = 0; i < primes.size(); i++)
     {
@@ -506,4 +1840,181 @@ void factorTrialDivision64(vector<uint64_t> &primes, vector<primePower64> &facto
 			return;
 		}
 	}
+}
+
+/**
+ * factorBruteForce - Reference factorization by trial division with every d up to
+ * sqrt(value), for checking factor64.
+ *
+ * @param value   Value to factor.
+ * @param factors (out) Prime powers of value, in increasing order of prime.
+ */
+
+static void factorBruteForce(uint64_t value, vector<primePower64> &factors)
+{
+    factors.clear();
+
+    for (uint64_t d = 2; d * d <= value; d++)
+    {
+        if (value % d == 0)
+        {
+            primePower64 newFactor = { d, 0 };
+
+            while (value % d == 0)
+            {
+                newFactor.power++;
+                value /= d;
+            }
+
+            factors.push_back(newFactor);
+        }
+    }
+
+    if (value > 1)
+    {
+        factors.push_back({ value, 1 });
+    }
+}
+
+/**
+ * samePrimePowers - Compare two factorizations.
+ *
+ * @param a First factorization.
+ * @param b Second factorization.
+ *
+ * @return True if both have the same primes to the same powers in the same order.
+ */
+
+static bool samePrimePowers(const vector<primePower64> &a, const vector<primePower64> &b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].prime != b[i].prime || a[i].power != b[i].power)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * randomPrime - Random prime in [2^(bits - 1), 2^bits), for building composites with
+ * known factors.
+ *
+ * @param bits Bit length, 2 to 64.
+ * @param rng  Random source.
+ *
+ * @return The prime.
+ */
+
+static uint64_t randomPrime(uint32_t bits, mt19937_64 &rng)
+{
+    uint64_t top = 1ull << (bits - 1);
+
+    while (true)
+    {
+        uint64_t p = top | (rng() & (top - 1));
+
+        if (isPrime(p))
+        {
+            return p;
+        }
+    }
+}
+
+/**
+ * TestFactor64 - Check factor64 against trial division on every value up to 10^5 and
+ * on random values up to 2^40. Then, where trial division is too slow, check it on
+ * products of random primes with known factors: semiprimes up to 64 bits, prime
+ * squares, and products of three and four primes. Also check each composite directly
+ * against pollardBrent, which has to return a proper divisor.
+ */
+
+void TestFactor64()
+{
+    mt19937_64 rng(531);
+    vector<primePower64> fast;
+    vector<primePower64> slow;
+
+    uint32_t fails  = 0;
+    uint32_t checks = 0;
+
+    for (uint64_t n = 0; n <= 100000; n++)
+    {
+        factor64(n, fast);
+        factorBruteForce(n, slow);
+        fails += !samePrimePowers(fast, slow);
+        checks++;
+    }
+
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        uint64_t n = rng() >> 24;
+
+        factor64(n, fast);
+        factorBruteForce(n, slow);
+        fails += !samePrimePowers(fast, slow);
+        checks++;
+    }
+
+    printf("factor64 mismatches against trial division: %u of %u\n", fails, checks);
+
+    // Composites with known factors. Each shape is a list of prime bit lengths, where 0
+    // repeats the previous prime.
+
+    const vector<vector<uint32_t>> shapes =
+    {
+        { 32, 32 }, { 31, 33 }, { 20, 44 }, { 11, 53 }, { 32, 0 }, { 21, 21, 22 }, { 16, 16, 16, 16 }
+    };
+
+    uint32_t knownFails     = 0;
+    uint32_t knownChecks    = 0;
+    uint32_t rhoFails       = 0;
+
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        for (auto& shape : shapes)
+        {
+            vector<uint64_t> primes;
+            uint64_t n = 1;
+
+            for (uint32_t bits : shape)
+            {
+                primes.push_back(bits ? randomPrime(bits, rng) : primes.back());
+                n *= primes.back();
+            }
+
+            sort(primes.begin(), primes.end());
+
+            vector<primePower64> expected;
+
+            for (uint64_t p : primes)
+            {
+                if (expected.size() > 0 && expected.back().prime == p)
+                {
+                    expected.back().power++;
+                }
+                else
+                {
+                    expected.push_back({ p, 1 });
+                }
+            }
+
+            factor64(n, fast);
+            knownFails += !samePrimePowers(fast, expected);
+            knownChecks++;
+
+            uint64_t d = pollardBrent(n);
+            rhoFails += (d <= 1 || d >= n || n % d != 0);
+        }
+    }
+
+    printf("factor64 mismatches on products of known primes: %u of %u\n", knownFails, knownChecks);
+    printf("pollardBrent non-divisors: %u of %u\n", rhoFails, knownChecks);
 }
\ No newline at end of file
@@ -69,7 +69,8 @@ pivotFound:
 
 /**
  * TestQuickSort Quick sort test. For 1000 iterations, generate lists of random
- * length and values, then sort. Capture list size and sort time for each list.
+ * length and values, then sort. Capture list size and sort time for each list, and
+ * report the throughput across all of them.
  */
 
 void TestQuickSort()
@@ -87,6 +88,9 @@ void TestQuickSort()
 
     srand(time(NULL));
 
+    uint64_t totalSize  = 0;
+    double totalTimeMS  = 0.0;
+
     for (uint32_t n = 0; n < numIters; n++)
     {
         // Generate a random list.
@@ -101,9 +105,10 @@ void TestQuickSort()
 
         // Sort the list and get time.
 
-        long long t1 = GetMilliseconds();
-        QuickSort(&list[0], size);
-        long long t2 = GetMilliseconds();
+        Timer timer;
+        timer.Start();
+        QuickSort(list.data(), size);
+        double sortTimeMS = timer.ElapsedMs();
 
         // Check list that list is really sorted and record results.
 
@@ -115,8 +120,11 @@ void TestQuickSort()
             }
         }
 
-        testResults[n] = { size, (double)(t2 - t1) };
+        testResults[n] = { size, sortTimeMS };
+        totalSize += size;
+        totalTimeMS += sortTimeMS;
     }
 
-    __debugbreak();
+    printf("Sorted %u lists, %llu values in %gms (%gns per value)\n", numIters,
+        (unsigned long long)totalSize, totalTimeMS, 1e6 * totalTimeMS / (double)max<uint64_t>(totalSize, 1));
 }
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "threadpool.h"
+
+/**
+ * Init - Start worker threads, each with its own task deque.
+ *
+ * @param numThreads Number of workers to start. Zero means one per hardware thread.
+ */
+
+void ThreadPool::Init(uint32_t numThreads)
+{
+    if (numThreads == 0)
+    {
+        numThreads = thread::hardware_concurrency();
+    }
+
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+
+    stopping = false;
+
+    for (uint32_t i = 0; i < numThreads; i++)
+    {
+        queues.emplace_back(new TaskQueue);
+    }
+
+    for (uint32_t i = 0; i < numThreads; i++)
+    {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+/**
+ * Shutdown - Let workers finish whatever is queued, then join them.
+ */
+
+void ThreadPool::Shutdown()
+{
+    if (workers.size() == 0)
+    {
+        return;
+    }
+
+    Wait();
+
+    {
+        lock_guard<mutex> lock(waitLock);
+        stopping = true;
+    }
+
+    taskReady.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    workers.clear();
+    queues.clear();
+}
+
+/**
+ * Submit - Queue a task. Tasks are dealt round-robin across worker deques.
+ *
+ * @param task   Task to run on some worker thread.
+ * @param pGroup Optional group to count the task against until it finishes.
+ */
+
+void ThreadPool::Submit(function<void()> task, TaskGroup *pGroup)
+{
+    assert(queues.size() > 0);
+
+    uint32_t idx = nextQueue++ % (uint32_t)queues.size();
+    pending++;
+
+    if (pGroup)
+    {
+        pGroup->pending++;
+
+        task = [this, pGroup, task]()
+        {
+            task();
+
+            if (--pGroup->pending == 0)
+            {
+                lock_guard<mutex> lock(waitLock);
+                tasksDone.notify_all();
+            }
+        };
+    }
+
+    {
+        lock_guard<mutex> lock(queues[idx]->lock);
+        queues[idx]->tasks.push_back(move(task));
+    }
+
+    {
+        lock_guard<mutex> lock(waitLock);
+        queued++;
+    }
+
+    taskReady.notify_one();
+}
+
+/**
+ * RunOne - Pop and run one task. Try the back of our own deque first, then steal from
+ * the front of every other deque in turn.
+ *
+ * @param home Index of the deque to try first.
+ *
+ * @return True if a task was run, false if every deque was empty.
+ */
+
+bool ThreadPool::RunOne(uint32_t home)
+{
+    function<void()> task;
+    uint32_t numQueues = (uint32_t)queues.size();
+
+    for (uint32_t i = 0; i < numQueues && !task; i++)
+    {
+        TaskQueue &queue = *queues[(home + i) % numQueues];
+        lock_guard<mutex> lock(queue.lock);
+
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+
+        if (i == 0)
+        {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+
+    queued--;
+    task();
+
+    if (--pending == 0)
+    {
+        lock_guard<mutex> lock(waitLock);
+        tasksDone.notify_all();
+    }
+
+    return true;
+}
+
+/**
+ * WorkerLoop - Run tasks until the pool shuts down, sleeping while there's nothing
+ * queued anywhere.
+ *
+ * @param idx Index of this worker's own deque.
+ */
+
+void ThreadPool::WorkerLoop(uint32_t idx)
+{
+    while (true)
+    {
+        if (RunOne(idx))
+        {
+            continue;
+        }
+
+        unique_lock<mutex> lock(waitLock);
+        taskReady.wait(lock, [this]() { return stopping || queued > 0; });
+
+        if (stopping && queued == 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * WaitFor - Run queued tasks on the calling thread until a counter drops to zero, and
+ * sleep whenever there's nothing left to steal.
+ *
+ * @param counter Count of outstanding tasks to wait on.
+ */
+
+void ThreadPool::WaitFor(atomic<uint64_t> &counter)
+{
+    uint32_t home = nextQueue % (uint32_t)queues.size();
+
+    while (counter > 0)
+    {
+        if (RunOne(home))
+        {
+            continue;
+        }
+
+        unique_lock<mutex> lock(waitLock);
+        tasksDone.wait(lock, [this, &counter]() { return counter == 0 || queued > 0; });
+    }
+}
+
+/**
+ * Wait - Block until every submitted task has finished. Don't call from inside a task,
+ * since that task counts as unfinished; wait on a TaskGroup instead.
+ */
+
+void ThreadPool::Wait()
+{
+    WaitFor(pending);
+}
+
+/**
+ * Wait - Block until every task in a group has finished, running queued tasks on the
+ * calling thread in the meantime.
+ *
+ * @param group Group to wait on.
+ */
+
+void ThreadPool::Wait(TaskGroup &group)
+{
+    WaitFor(group.pending);
+}
+
+/**
+ * GetThreadPool - Shared pool with one worker per hardware thread, started on
+ * first use.
+ *
+ * @return Reference to the shared pool.
+ */
+
+ThreadPool& GetThreadPool()
+{
+    static ThreadPool pool;
+    static once_flag initFlag;
+
+    call_once(initFlag, []() { pool.Init(); });
+
+    return pool;
+}
+
+/**
+ * ParallelFor - Run body(i) for each i in [begin, end) on the shared pool. Indices
+ * are split into a few chunks per worker so stealing can even out uneven costs.
+ *
+ * @param begin First index.
+ * @param end   One past the last index.
+ * @param body  Function to run for each index.
+ */
+
+void ParallelFor(uint64_t begin, uint64_t end, function<void(uint64_t)> body)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    ThreadPool &pool    = GetThreadPool();
+    uint64_t count      = end - begin;
+    uint64_t numChunks  = 8 * (uint64_t)pool.NumThreads();
+
+    if (numChunks > count)
+    {
+        numChunks = count;
+    }
+
+    uint64_t chunkSize = (count + numChunks - 1) / numChunks;
+    TaskGroup group;
+
+    for (uint64_t lo = begin; lo < end; lo += chunkSize)
+    {
+        uint64_t hi = lo + chunkSize < end ? lo + chunkSize : end;
+
+        pool.Submit([lo, hi, &body]()
+        {
+            for (uint64_t i = lo; i < hi; i++)
+            {
+                body(i);
+            }
+        }, &group);
+    }
+
+    pool.Wait(group);
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include <random>
 
 /**
  * gcd - Compute greatest common divisor of integers 
@@ -12,14 +13,7 @@
 
 uint32_t gcd(uint32_t a, uint32_t b)
 {
-    uint32_t c;
-    while (a != 0)
-    {
-        c = a;
-        a = b % a;
-        b = c;
-    }
-    return b;
+    return (uint32_t)gcdBinary64(a, b);
 }
 
 /**
@@ -34,14 +28,7 @@ uint32_t gcd(uint32_t a, uint32_t b)
 
 uint64_t gcd64(uint64_t a, uint64_t b)
 {
-    uint64_t c;
-    while (a != 0) 
-    {
-        c = a; 
-        a = b % a;
-        b = c;
-    }
-    return b;
+    return gcdBinary64(a, b);
 }
 
 /**
@@ -67,59 +54,250 @@ double gcdDbl(double a, double b)
 }
 
 /**
- * [gcdExtended description]
- * @param  a [description]
- * @param  b [description]
- * @param  x [description]
- * @param  y [description]
- * @return   [description]
+ * gcdExtended - Extended Euclidean algorithm. Runs the signed version, which reduces b
+ * mod a first like the old recursion did, so a == b and zero inputs get the same
+ * coefficients as before. Coefficients are computed exactly and then truncated to 32
+ * bits, i.e., they're correct mod 2^32.
+ *
+ * @param a First value.
+ * @param b Second value.
+ * @param x (out) Coefficient of a.
+ * @param y (out) Coefficient of b, with a * x + b * y = gcd(a, b).
+ *
+ * @return Greatest common divisor of a and b.
  */
 
 uint32_t gcdExtended(uint32_t a, uint32_t b, uint32_t &x, uint32_t &y)
 {
-    if (a == 0)
+    int64_t x64;
+    int64_t y64;
+    uint32_t gcd = (uint32_t)gcdExtended((int64_t)a, (int64_t)b, x64, y64);
+
+    x = (uint32_t)x64;
+    y = (uint32_t)y64;
+
+    return gcd;
+}
+
+/**
+ * gcdExtended - Extended Euclidean algorithm on signed values, run iteratively. Follows
+ * C's truncating division, so negative inputs get the same quotients (and the same
+ * coefficients) as the textbook recursion on b % a.
+ *
+ * @param a First value.
+ * @param b Second value.
+ * @param x (out) Coefficient of a.
+ * @param y (out) Coefficient of b, with a * x + b * y = gcd(a, b).
+ *
+ * @return Greatest common divisor of a and b, with the sign the recursion would give.
+ */
+
+int64_t gcdExtended(int64_t a, int64_t b, int64_t &x, int64_t &y)
+{
+    int64_t r0 = b;
+    int64_t r1 = a;
+    int64_t s0 = 0;
+    int64_t s1 = 1;
+    int64_t t0 = 1;
+    int64_t t1 = 0;
+
+    while (r1 != 0)
     {
-        x = 0;
-        y = 1;
-        return b;
+        int64_t q  = r0 / r1;
+        int64_t r2 = r0 % r1;
+        int64_t s2 = s0 - q * s1;
+        int64_t t2 = t0 - q * t1;
+
+        r0 = r1;
+        r1 = r2;
+        s0 = s1;
+        s1 = s2;
+        t0 = t1;
+        t1 = t2;
     }
 
-    uint32_t x1;
-    uint32_t y1;
-    uint32_t gcd = gcdExtended(b % a, a, x1, y1);
+    x = s0;
+    y = t0;
 
-    x = y1 - (b / a) * x1;
-    y = x1;
+    return r0;
+}
 
-    return gcd;
+/**
+ * crtMerge - Combine x = a mod n and x = b mod m into one congruence mod lcm(n, m). With
+ * g = gcd(n, m), a solution exists iff g divides b - a. Then x = a + k * n, where
+ * k = ((b - a) / g) * (n / g)^-1 mod m / g, and one extended gcd supplies both g and the
+ * inverse. Products that can pass 64 bits go through 128-bit intermediates.
+ *
+ * @param a (in/out) First residue. Replaced by the merged residue, the minimum
+ * non-negative solution.
+ * @param n (in/out) First modulus. Replaced by lcm(n, m).
+ * @param b Second residue.
+ * @param m Second modulus.
+ *
+ * @return False, with a and n untouched, if the congruences are inconsistent or
+ * lcm(n, m) doesn't fit in 64 bits.
+ */
+
+bool crtMerge(uint64_t &a, uint64_t &n, uint64_t b, uint64_t m)
+{
+    int64_t x;
+    int64_t y;
+
+    uint64_t g      = gcdExtended64(n, m, x, y);
+    uint64_t ng     = n / g;
+    uint64_t mg     = m / g;
+    uint64_t lcmHi;
+    uint64_t lcm    = mul128(ng, m, lcmHi);
+
+    if (lcmHi != 0)
+    {
+        return false;
+    }
+
+    uint64_t aRem   = a % n;
+    uint64_t aModM  = aRem % m;
+    uint64_t bRem   = b % m;
+    uint64_t diff   = (bRem >= aModM) ? bRem - aModM : bRem + (m - aModM);
+
+    if (diff % g != 0)
+    {
+        return false;
+    }
+
+    // (n / g) * x = 1 mod m / g, and x can come back negative.
+
+    uint64_t inv    = (x < 0) ? mg - ((uint64_t)(-x) % mg) : (uint64_t)x % mg;
+    uint64_t hi;
+    uint64_t lo     = mul128((diff / g) % mg, inv, hi);
+    uint64_t k;
+
+    div128(hi, lo, mg, k);
+
+    a = aRem + k * n;
+    n = lcm;
+
+    return true;
 }
 
 /**
- * [gcdExtended description]
- * @param  a [description]
- * @param  b [description]
- * @param  x [description]
- * @param  y [description]
- * @return   [description]
+ * crt - Solve a system of congruences x = r_i mod m_i. The moduli don't need to be
+ * coprime. Congruences are merged left to right with crtMerge.
+ *
+ * @param congruences List of (residue, modulus) pairs. Moduli must be nonzero.
+ *
+ * @return (x, lcm of the moduli), with x the minimum non-negative solution. Empty if
+ * the system has no solution or the lcm doesn't fit in 64 bits.
  */
 
-int64_t gcdExtended(int64_t a, int64_t b, int64_t &x, int64_t &y)
+optional<pair<uint64_t, uint64_t>> crt(const vector<pair<uint64_t, uint64_t>> &congruences)
 {
-    if (a == 0)
+    uint64_t x = 0;
+    uint64_t n = 1;
+
+    for (auto &congruence : congruences)
     {
-        x = 0;
-        y = 1;
-        return b;
+        if (!crtMerge(x, n, congruence.first, congruence.second))
+        {
+            return nullopt;
+        }
     }
 
-    int64_t x1;
-    int64_t y1;
-    int64_t gcd = gcdExtended(b % a, a, x1, y1);
+    return make_pair(x, n);
+}
+
+/**
+ * crtBatch - Solve many independent pairs of congruences x = a mod n, x = b mod m.
+ * Nothing is allocated, so this can sit in a hot loop with reused buffers. Since 0 is a
+ * valid solution, pairs with none are marked with a value the caller picks.
+ *
+ * @param as       First residues.
+ * @param ns       First moduli.
+ * @param bs       Second residues.
+ * @param ms       Second moduli.
+ * @param out      (out) Minimum non-negative solution to each pair, or fallback if the
+ * pair has no solution (or its lcm doesn't fit in 64 bits). May alias any of the inputs.
+ * @param count    Number of pairs.
+ * @param fallback Value written for pairs with no solution.
+ *
+ * @return Number of pairs that had a solution.
+ */
 
-    x = y1 - (b / a) * x1;
-    y = x1;
+size_t crtBatch(const uint64_t* as, const uint64_t* ns, const uint64_t* bs, const uint64_t* ms, uint64_t* out, size_t count, uint64_t fallback)
+{
+    size_t solved = 0;
 
-    return gcd;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t x  = as[i];
+        uint64_t n  = ns[i];
+        bool found  = crtMerge(x, n, bs[i], ms[i]);
+
+        out[i]  = found ? x : fallback;
+        solved  += found;
+    }
+
+    return solved;
+}
+
+/**
+ * frac::Normalize - Reduce to lowest terms. When the numerator and denominator both fit
+ * in one 64-bit limb, which covers most of the fractions the problems build, take the
+ * gcd with gcdBinary64 and divide it out exactly: shift off its power of two, then
+ * multiply by the inverse of its odd part mod 2^64. Only bigger values go through
+ * mpz_gcd and mpz division.
+ */
+
+void frac::Normalize()
+{
+    if (sizeof(mp_limb_t) == sizeof(uint64_t) &&
+        mpz_size(num.get_mpz_t()) <= 1 &&
+        mpz_size(den.get_mpz_t()) <= 1)
+    {
+        uint64_t n  = (uint64_t)mpz_getlimbn(num.get_mpz_t(), 0);
+        uint64_t d  = (uint64_t)mpz_getlimbn(den.get_mpz_t(), 0);
+        uint64_t c  = gcdBinary64(n, d);
+
+        if (c <= 1)
+        {
+            return;
+        }
+
+        uint32_t shift  = ctz64(c);
+        uint64_t odd    = c >> shift;
+        uint64_t oddInv = odd;
+
+        for (uint32_t k = 0; k < 5; k++)
+        {
+            oddInv *= 2 - odd * oddInv;
+        }
+
+        n = (n >> shift) * oddInv;
+        d = (d >> shift) * oddInv;
+
+        int numSign = mpz_sgn(num.get_mpz_t());
+        int denSign = mpz_sgn(den.get_mpz_t());
+
+        mpz_import(num.get_mpz_t(), 1, -1, sizeof(uint64_t), 0, 0, &n);
+        mpz_import(den.get_mpz_t(), 1, -1, sizeof(uint64_t), 0, 0, &d);
+
+        if (numSign < 0)
+        {
+            num = -num;
+        }
+
+        if (denSign < 0)
+        {
+            den = -den;
+        }
+
+        return;
+    }
+
+    mpz_class c;
+    mpz_gcd(c.get_mpz_t(), num.get_mpz_t(), den.get_mpz_t());
+
+    num /= c;
+    den /= c;
 }
 
 /**
@@ -215,7 +393,7 @@ void computeKConvergent(continuedFrac &frac, uint64_t k, uint64_t &a, uint64_t &
         n2 = newTerm * n1 + n0;
         d2 = newTerm * d1 + d0;
 
-        uint64_t c = gcd((uint32_t)n2, (uint32_t)d2);
+        uint64_t c = gcd64(n2, d2);
         n2 /= c;
         d2 /= c;
 
@@ -371,44 +549,20 @@ bool isPalindromic64(uint64_t value)
 
 uint32_t powMod(uint32_t b, uint32_t e, uint32_t n)
 {
-    uint32_t result = 1;
-    while (e > 0)
-    {
-        if (e % 2 == 1)
-        {
-            result = (result * b) % n;
-        }
-
-        e = e >> 1;
-        b = (b * b) % n;
-    }
-    return result;
-}
+    uint64_t result = 1 % n;
+    uint64_t base   = b % n;
 
-/**
- * powMod64 - Quickly compute b^e mod n 64-bit uints.
- *
- * @param b Base value.
- * @param e Exponent.
- * @param n Modulus.
- *
- * @return result of b^e mod n.
- */
-
-int64_t powMod64(int64_t b, int64_t e, int64_t n)
-{
-    int64_t result = 1;
     while (e > 0)
     {
         if (e % 2 == 1)
         {
-            result = (result * b) % n;
+            result = (result * base) % n;
         }
 
         e = e >> 1;
-        b = (b * b) % n;
+        base = (base * base) % n;
     }
-    return result;
+    return (uint32_t)result;
 }
 
 /**
@@ -543,24 +697,138 @@ uint64_t geomSum(uint64_t r, uint64_t n)
 }
 
 /**
- * Get Milliseconds - CPU timer function. Get milliseconds elapsed since start of epoch.
+ * crtBruteForce - Reference CRT by stepping through the solutions of the first
+ * congruence until one fits the rest.
  *
- * @return Milliseconds since start of epoch as 64bit int.
+ * @param congruences List of (residue, modulus) pairs, with a small lcm.
+ *
+ * @return Minimum non-negative solution, or empty if there's none below the lcm.
  */
 
-long long GetMilliseconds()
+static optional<uint64_t> crtBruteForce(const vector<pair<uint64_t, uint64_t>> &congruences)
 {
-    static LARGE_INTEGER frequency;
-    static BOOL useQpc = QueryPerformanceFrequency(&frequency);
+    uint64_t lcm = 1;
 
-    if (useQpc)
+    for (auto &congruence : congruences)
     {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        return (1000LL * now.QuadPart) / frequency.QuadPart;
+        lcm = lcm / gcd64(lcm, congruence.second) * congruence.second;
     }
-    else
+
+    uint64_t step   = congruences.empty() ? 1 : congruences[0].second;
+    uint64_t start  = congruences.empty() ? 0 : congruences[0].first % step;
+
+    for (uint64_t x = start; x < lcm; x += step)
     {
-        return GetTickCount();
+        bool fits = true;
+
+        for (auto &congruence : congruences)
+        {
+            fits = fits && (x % congruence.second == congruence.first % congruence.second);
+        }
+
+        if (fits)
+        {
+            return x;
+        }
     }
+
+    return nullopt;
+}
+
+/**
+ * TestCRT - Check crt against brute force on small systems of up to four congruences,
+ * consistent or not. Then check it on pairs of large moduli with shared factors, where
+ * any answer has to satisfy both congruences and come with the right lcm, and an empty
+ * one has to mean the pair is inconsistent or the lcm passes 64 bits. crtBatch has to
+ * agree with crt on the same pairs, writing the fallback where crt finds nothing.
+ */
+
+void TestCRT()
+{
+    mt19937_64 rng(16);
+
+    uint32_t smallFails     = 0;
+    uint32_t smallChecks    = 20000;
+
+    for (uint32_t i = 0; i < smallChecks; i++)
+    {
+        vector<pair<uint64_t, uint64_t>> congruences(rng() % 5);
+
+        for (auto &congruence : congruences)
+        {
+            congruence.second   = 1 + rng() % 30;
+            congruence.first    = rng() % (3 * congruence.second);
+        }
+
+        auto fast = crt(congruences);
+        auto slow = crtBruteForce(congruences);
+
+        uint64_t lcm = 1;
+
+        for (auto &congruence : congruences)
+        {
+            lcm = lcm / gcd64(lcm, congruence.second) * congruence.second;
+        }
+
+        smallFails += (fast.has_value() != slow.has_value()) ||
+            (fast && (fast->first != *slow || fast->second != lcm));
+    }
+
+    printf("crt mismatches against brute force: %u of %u\n", smallFails, smallChecks);
+
+    // Large pairs. Half are built consistent from a known solution.
+
+    const size_t numPairs = 100000;
+
+    vector<uint64_t> as(numPairs);
+    vector<uint64_t> ns(numPairs);
+    vector<uint64_t> bs(numPairs);
+    vector<uint64_t> ms(numPairs);
+    vector<uint64_t> xs(numPairs);
+
+    for (size_t i = 0; i < numPairs; i++)
+    {
+        uint64_t g  = 1 + (rng() >> (32 + rng() % 32));
+        ns[i]       = max<uint64_t>(1, (rng() >> (rng() % 64)) / g) * g;
+        ms[i]       = max<uint64_t>(1, (rng() >> (rng() % 64)) / g) * g;
+
+        uint64_t x  = rng();
+        as[i]       = (i % 2 == 0) ? x % ns[i] : rng();
+        bs[i]       = (i % 2 == 0) ? x % ms[i] : rng();
+    }
+
+    const uint64_t fallback = ~0ull;
+
+    uint32_t largeFails = 0;
+    uint32_t batchFails = 0;
+    size_t solved       = 0;
+
+    size_t batchSolved = crtBatch(as.data(), ns.data(), bs.data(), ms.data(), xs.data(), numPairs, fallback);
+
+    for (size_t i = 0; i < numPairs; i++)
+    {
+        uint64_t n = ns[i];
+        uint64_t m = ms[i];
+        uint64_t g = gcd64(n, m);
+
+        uint64_t lcmHi;
+        uint64_t lcm = mul128(n / g, m, lcmHi);
+
+        uint64_t aRem = as[i] % n;
+        uint64_t bRem = bs[i] % m;
+        bool solvable = (aRem % g == bRem % g) && lcmHi == 0;
+
+        auto fast = crt({ { as[i], n }, { bs[i], m } });
+
+        largeFails += (fast.has_value() != solvable) ||
+            (fast && (fast->second != lcm || fast->first >= lcm || fast->first % n != aRem || fast->first % m != bRem));
+
+        batchFails += fast ? (xs[i] != fast->first) : (xs[i] != fallback);
+        solved += fast.has_value();
+    }
+
+    batchFails += (batchSolved != solved);
+
+    printf("crt failures on large pairs: %u of %u\n", largeFails, (uint32_t)numPairs);
+    printf("crtBatch mismatches against crt: %u of %u\n", batchFails, (uint32_t)numPairs);
 }
\ No newline at end of file